@@ -190,19 +190,19 @@ compile_project() {
         
         # Compilar versión serial
         if [ -f "main_serial.c" ]; then
-            gcc -Wall -Wextra -std=gnu99 -O2 -o huffman_serial main_serial.c readFile.c tree.c -lm
+            gcc -Wall -Wextra -std=gnu99 -O2 -o huffman_serial main_serial.c readFile.c readFile_blocks.c readFile_transform.c readFile_lz.c readFile_walk.c tree.c -lm -lpthread
             print_success "Versión serial compilada"
         fi
         
         # Compilar versión fork
         if [ -f "main_fork.c" ] && [ -f "readFile_fork.c" ]; then
-            gcc -Wall -Wextra -std=gnu99 -O2 -o huffman_fork main_fork.c readFile.c readFile_fork.c tree.c -lm
+            gcc -Wall -Wextra -std=gnu99 -O2 -o huffman_fork main_fork.c readFile.c readFile_blocks.c readFile_transform.c readFile_lz.c readFile_walk.c readFile_fork.c tree.c -lm -lpthread
             print_success "Versión fork compilada"
         fi
         
         # Compilar versión pthread si existe
         if [ -f "main_pthread.c" ] && [ -f "readFile_pthread.c" ]; then
-            gcc -Wall -Wextra -std=gnu99 -O2 -o huffman_pthread main_pthread.c readFile.c readFile_pthread.c tree.c -lm -lpthread
+            gcc -Wall -Wextra -std=gnu99 -O2 -o huffman_pthread main_pthread.c readFile.c readFile_blocks.c readFile_transform.c readFile_lz.c readFile_walk.c readFile_pthread.c tree.c -lm -lpthread
             print_success "Versión pthread compilada"
         fi
     fi
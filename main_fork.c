@@ -17,6 +17,7 @@ typedef struct {
     bool verbose;
     bool benchmark;
     bool help;
+    int jobs;               // Procesos del pool (0 = uno por núcleo)
 } Options;
 
 void printUsage(const char* program_name) {
@@ -29,6 +30,7 @@ void printUsage(const char* program_name) {
     printf("  -c, --compress-only     Solo comprimir (no descomprimir)\n");
     printf("  -u, --decompress-only   Solo descomprimir (especificar -o como entrada)\n");
     printf("  -b, --benchmark         Comparar rendimiento con versión serial\n");
+    printf("  -j, --jobs N            Máximo de procesos hijos a la vez (por defecto: núcleos)\n");
     printf("  -v, --verbose           Mostrar información detallada del proceso\n");
     printf("  -h, --help              Mostrar esta ayuda\n");
     printf("\nEjemplos:\n");
@@ -59,13 +61,14 @@ Options parseArguments(int argc, char* argv[]) {
         {"compress-only", no_argument, 0, 'c'},
         {"decompress-only", no_argument, 0, 'u'},
         {"benchmark", no_argument, 0, 'b'},
+        {"jobs", required_argument, 0, 'j'},
         {"verbose", no_argument, 0, 'v'},
         {"help", no_argument, 0, 'h'},
         {0, 0, 0, 0}
     };
     
     int c;
-    while ((c = getopt_long(argc, argv, "d:o:x:cubvh", long_options, NULL)) != -1) {
+    while ((c = getopt_long(argc, argv, "d:o:x:j:cubvh", long_options, NULL)) != -1) {
         switch (c) {
             case 'd':
                 opts.input_dir = optarg;
@@ -85,6 +88,9 @@ Options parseArguments(int argc, char* argv[]) {
             case 'b':
                 opts.benchmark = true;
                 break;
+            case 'j':
+                opts.jobs = atoi(optarg);
+                break;
             case 'v':
                 opts.verbose = true;
                 break;
@@ -111,6 +117,7 @@ int main(int argc, char* argv[]) {
     
     printf("=== ALGORITMO DE HUFFMAN - VERSIÓN PARALELA CON FORK() ===\n");
     printf("PID del proceso principal: %d\n", getpid());
+    setForkProcessLimit(opts.jobs);
     
     if (opts.verbose) {
         printf("\nConfiguración:\n");
@@ -100,7 +100,10 @@ int main(int argc, char* argv[]) {
         
         printf("\n--- Ejecutando versión PTHREAD ---\n");
         long long start = getCurrentTimeMs();
-        compressDirectoryPthread(opts.input_dir, opts.output_file);
+        if (!compressDirectoryPthread(opts.input_dir, opts.output_file)) {
+            printf("✗ Error en la compresión con Pthread\n");
+            return 1;
+        }
         long long end = getCurrentTimeMs();
         pthread_compress_time = end - start;
         printf("✓ Compresión con Pthread: %lld ms\n", pthread_compress_time);
@@ -120,7 +123,10 @@ int main(int argc, char* argv[]) {
 
         printf("\n--- Ejecutando descompresión PTHREAD ---\n");
         long long start = getCurrentTimeMs();
-        decompressDirectoryPthread(opts.output_file, opts.extract_dir);
+        if (!decompressDirectoryPthread(opts.output_file, opts.extract_dir)) {
+            printf("✗ Error en la descompresión con Pthread\n");
+            return 1;
+        }
         long long end = getCurrentTimeMs();
         pthread_decompress_time = end - start;
         printf("✓ Descompresión con Pthread: %lld ms\n", pthread_decompress_time);
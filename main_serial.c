@@ -15,6 +15,17 @@ typedef struct {
     bool decompress_only;
     bool verbose;
     bool help;
+    char** member_names;    // Miembros pedidos con -f (NULL = todos)
+    int member_count;
+    int sync_kb;            // Puntos de sincronización cada N KB (0 = bloques)
+    bool transform;         // BWT + MTF + rachas de ceros antes de Huffman
+    int lz_level;           // Nivel de LZ77 (0 = sin LZ77)
+    bool solid;             // Juntar los archivos chicos en grupos con una sola tabla
+    const char* dictionary; // Diccionario entrenado para comprimir y descomprimir (NULL = ninguno)
+    const char* train_dir;  // Entrenar el diccionario con este directorio y salir
+    bool order1;            // Probar el modelo de contexto de orden 1 en cada miembro
+    int max_code_length;    // Límite de longitud de código (0 = el de por defecto)
+    int stream;             // 'C'/'A' = comprimir stdin a stdout (tramas/adaptativo), 'U' = descomprimir, 0 = no
 } Options;
 
 void printUsage(const char* program_name) {
@@ -26,12 +37,33 @@ void printUsage(const char* program_name) {
     printf("  -x, --extract DIR       Directorio donde extraer archivos\n");
     printf("  -c, --compress-only     Solo comprimir (no descomprimir)\n");
     printf("  -u, --decompress-only   Solo descomprimir (especificar -o como entrada)\n");
+    printf("  -f, --file NOMBRE       Extraer solo ese archivo (se puede repetir)\n");
+    printf("  -s, --sync KB           Archivos grandes: una sola tabla con puntos de\n");
+    printf("                          sincronización cada KB kilobytes (en vez de bloques)\n");
+    printf("  -L, --max-code-length N Longitud máxima de los códigos, de 8 a 64 (por defecto %d)\n",
+           HUFF_DEFAULT_CODE_LENGTH_LIMIT);
+    printf("  -T, --transform         Transformada previa BWT + MTF + rachas de ceros (mejor en texto)\n");
+    printf("  -z, --lz NIVEL          LZ77 + Huffman, de 1 (rápido) a %d (más chico); 0 = sin LZ77\n",
+           HUFF_LZ_MAX_LEVEL);
+    printf("  -S, --solid             Juntar los archivos chicos (hasta %d KB) en grupos con una sola tabla\n",
+           HUFF_SOLID_MEMBER_MAX / 1024);
+    printf("  -t, --train DIR         Entrenar un diccionario con los archivos de DIR y guardarlo en -D\n");
+    printf("  -D, --dictionary FILE   Usar el diccionario FILE (hace falta también al descomprimir)\n");
+    printf("  -O, --order1            Tablas por byte anterior (orden 1) cuando el archivo sale más chico\n");
+    printf("  -C, --stream-compress   Comprimir stdin a stdout (por tramas, memoria constante)\n");
+    printf("  -A, --adaptive          Comprimir stdin a stdout con Huffman adaptativo\n");
+    printf("                          (un solo paso, cada lectura sale apenas llega)\n");
+    printf("  -U, --stream-decompress Descomprimir stdin a stdout\n");
     printf("  -v, --verbose           Mostrar información detallada\n");
     printf("  -h, --help              Mostrar esta ayuda\n");
     printf("\nEjemplos:\n");
     printf("  %s -d ./textos -o archivo.bin -x ./extraidos\n", program_name);
     printf("  %s -d ./textos -o archivo.bin -c\n", program_name);
     printf("  %s -o archivo.bin -x ./extraidos -u\n", program_name);
+    printf("  %s -o archivo.bin -x ./extraidos -u -f notas.txt\n", program_name);
+    printf("  %s -t ./muestras -D textos.dict\n", program_name);
+    printf("  %s -d ./textos -o archivo.bin -D textos.dict\n", program_name);
+    printf("  tar c ./textos | %s -C | ssh host '%s -U | tar x'\n", program_name, program_name);
     printf("\n");
 }
 
@@ -53,13 +85,25 @@ Options parseArguments(int argc, char* argv[]) {
         {"extract", required_argument, 0, 'x'},
         {"compress-only", no_argument, 0, 'c'},
         {"decompress-only", no_argument, 0, 'u'},
+        {"file", required_argument, 0, 'f'},
+        {"sync", required_argument, 0, 's'},
+        {"stream-compress", no_argument, 0, 'C'},
+        {"stream-decompress", no_argument, 0, 'U'},
+        {"adaptive", no_argument, 0, 'A'},
+        {"max-code-length", required_argument, 0, 'L'},
+        {"order1", no_argument, 0, 'O'},
+        {"transform", no_argument, 0, 'T'},
+        {"lz", required_argument, 0, 'z'},
+        {"solid", no_argument, 0, 'S'},
+        {"train", required_argument, 0, 't'},
+        {"dictionary", required_argument, 0, 'D'},
         {"verbose", no_argument, 0, 'v'},
         {"help", no_argument, 0, 'h'},
         {0, 0, 0, 0}
     };
     
     int c;
-    while ((c = getopt_long(argc, argv, "d:o:x:cuvh", long_options, NULL)) != -1) {
+    while ((c = getopt_long(argc, argv, "d:o:x:f:s:L:z:t:D:SOTCUAcuvh", long_options, NULL)) != -1) {
         switch (c) {
             case 'd':
                 opts.input_dir = optarg;
@@ -70,6 +114,39 @@ Options parseArguments(int argc, char* argv[]) {
             case 'x':
                 opts.extract_dir = optarg;
                 break;
+            case 'f':
+                opts.member_names = realloc(opts.member_names, (opts.member_count + 1) * sizeof(char*));
+                opts.member_names[opts.member_count++] = optarg;
+                break;
+            case 's':
+                opts.sync_kb = atoi(optarg);
+                break;
+            case 'T':
+                opts.transform = true;
+                break;
+            case 'z':
+                opts.lz_level = atoi(optarg);
+                break;
+            case 'S':
+                opts.solid = true;
+                break;
+            case 't':
+                opts.train_dir = optarg;
+                break;
+            case 'D':
+                opts.dictionary = optarg;
+                break;
+            case 'O':
+                opts.order1 = true;
+                break;
+            case 'L':
+                opts.max_code_length = atoi(optarg);
+                break;
+            case 'C':
+            case 'U':
+            case 'A':
+                opts.stream = c;
+                break;
             case 'c':
                 opts.compress_only = true;
                 break;
@@ -105,8 +182,48 @@ int main(int argc, char* argv[]) {
         printUsage(argv[0]);
         return 0;
     }
+
+    if (opts.max_code_length != 0 && !setCodeLengthLimit(opts.max_code_length)) {
+        fprintf(stderr, "Error: la longitud máxima de código debe estar entre %d y %d\n",
+                HUFF_MIN_CODE_LENGTH_LIMIT, HUFF_MAX_CODE_LENGTH);
+        return 1;
+    }
+
+    if (!setLzLevel(opts.lz_level)) {
+        fprintf(stderr, "Error: el nivel de LZ77 debe estar entre 0 y %d\n", HUFF_LZ_MAX_LEVEL);
+        return 1;
+    }
+
+    if (opts.train_dir != NULL) {
+        if (opts.dictionary == NULL) {
+            fprintf(stderr, "Error: falta el archivo del diccionario (-D)\n");
+            return 1;
+        }
+        return trainDictionary(opts.train_dir, opts.dictionary) ? 0 : 1;
+    }
+    if (opts.dictionary != NULL && !loadDictionary(opts.dictionary)) {
+        return 1;
+    }
+
+    setSolidGroups(opts.solid);
+    setContextModeling(opts.order1);
+    setBlockTransform(opts.transform);
+
+    // Modo filtro: stdout lleva solo los datos, nada de mensajes
+    if (opts.stream == 'C') {
+        return compressStreaming(stdin, stdout) ? 0 : 1;
+    }
+    if (opts.stream == 'A') {
+        return compressAdaptive(stdin, stdout) ? 0 : 1;
+    }
+    if (opts.stream == 'U') {
+        return decompressStream(stdin, stdout) && fflush(stdout) == 0 ? 0 : 1;
+    }
     
     printf("=== ALGORITMO DE HUFFMAN - VERSIÓN SERIAL ===\n");
+    if (opts.sync_kb > 0) {
+        setSyncPointInterval((size_t)opts.sync_kb * 1024);
+    }
     
     if (opts.verbose) {
         printf("Configuración:\n");
@@ -152,7 +269,10 @@ int main(int argc, char* argv[]) {
         printf("\n=== DESCOMPRESIÓN SERIAL ===\n");
         long long start = getCurrentTimeMs();
         
-        if (decompressDirectory(opts.output_file, opts.extract_dir)) {
+        bool ok = (opts.member_count > 0)
+            ? extractFilesFromArchive(opts.output_file, opts.extract_dir, opts.member_names, opts.member_count)
+            : decompressDirectory(opts.output_file, opts.extract_dir);
+        if (ok) {
             long long end = getCurrentTimeMs();
             decompress_time = end - start;
             printf("✓ Descompresión completada en: %lld ms\n", decompress_time);
@@ -187,5 +307,6 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    free(opts.member_names);
     return 0;
 }
\ No newline at end of file
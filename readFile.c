@@ -1,3 +1,4 @@
+#define _GNU_SOURCE  // copy_file_range
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
@@ -7,6 +8,13 @@
 #include <dirent.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
 
 
 //--------------------------------------------------------------------------//
@@ -41,65 +49,112 @@ void addLetterFrequency(const unsigned char letter){
     alphabet[index].frequency += 1;
 }
 
+// Orden descendente por frecuencia; en empate primero el símbolo menor
+static int compareLettersDescending(const void* a, const void* b) {
+    const struct letter* left = (const struct letter*)a;
+    const struct letter* right = (const struct letter*)b;
+    if (left->frequency != right->frequency) {
+        return (left->frequency > right->frequency) ? -1 : 1;
+    }
+    return (int)left->letter - (int)right->letter;
+}
+
+// Copia las letras con frecuencia > 0 y las ordena de mayor a menor
+static struct letter* sortLetters(const struct letter* source, int* out_size) {
+    int amount = 0;
+    for (int i = 0; i < 256; i++) {
+        if (source[i].frequency != 0)
+            amount++;
+    }
+    *out_size = amount;
+
+    struct letter* resultList = (struct letter*)malloc((amount > 0 ? amount : 1) * sizeof(struct letter));
+    if (resultList == NULL) {
+        return NULL;
+    }
+    int index = 0;
+    for (int i = 0; i < 256; i++) {
+        if (source[i].frequency != 0)
+            resultList[index++] = source[i];
+    }
+    qsort(resultList, amount, sizeof(struct letter), compareLettersDescending);
+    return resultList;
+}
+
 /*
-    Terrible sort
+    Conteo de frecuencias
     --------------------------------------------------------
-    1- Count the amount of values in the alphabet array that aren't 
-    set to 0, that's the required space for the result array.
-    
-    Then in a while true:
+    Un solo arreglo con frequencies[c]++ por byte se frena en rachas del
+    mismo carácter: cada incremento espera al anterior (store -> load).
+    Aquí se leen 8 bytes a la vez y se reparten entre 4 tablas, así bytes
+    iguales y seguidos caen en contadores distintos. Al final se suman.
+    Las tablas son de 32 bits, por eso se procesa en trozos de 1 GB.
+    -------------------------------------------------------
+*/
+#define HISTOGRAM_TABLES 4
+#define HISTOGRAM_CHUNK ((size_t)1 << 30)
 
-    2- Get the index of the most frequent value in the array
+/**
+ * @brief Cuenta los bytes de un rango de memoria y los SUMA a frequencies.
+ * @param frequencies Arreglo de 256 contadores (no se pone en cero aquí).
+ */
+void countFrequencies(const unsigned char* data, size_t size, unsigned long long* frequencies) {
+    unsigned int tables[HISTOGRAM_TABLES][256];
 
-    3- Place it at the first possible position in the result array
+    while (size > 0) {
+        size_t chunk = (size < HISTOGRAM_CHUNK) ? size : HISTOGRAM_CHUNK;
+        memset(tables, 0, sizeof(tables));
 
-    4- set the value of the index in the first array to 0
+        size_t i = 0;
+        for (; i + 16 <= chunk; i += 16) {
+            unsigned long long first, second;
+            memcpy(&first, data + i, 8);
+            memcpy(&second, data + i + 8, 8);
+            tables[0][first & 0xFF]++;
+            tables[1][(first >> 8) & 0xFF]++;
+            tables[2][(first >> 16) & 0xFF]++;
+            tables[3][(first >> 24) & 0xFF]++;
+            tables[0][(first >> 32) & 0xFF]++;
+            tables[1][(first >> 40) & 0xFF]++;
+            tables[2][(first >> 48) & 0xFF]++;
+            tables[3][first >> 56]++;
+            tables[0][second & 0xFF]++;
+            tables[1][(second >> 8) & 0xFF]++;
+            tables[2][(second >> 16) & 0xFF]++;
+            tables[3][(second >> 24) & 0xFF]++;
+            tables[0][(second >> 32) & 0xFF]++;
+            tables[1][(second >> 40) & 0xFF]++;
+            tables[2][(second >> 48) & 0xFF]++;
+            tables[3][second >> 56]++;
+        }
+        for (; i < chunk; i++) {
+            tables[0][data[i]]++;
+        }
 
-    5- Repeat steps 2-3-4 until all values in the first array are 0
-        Then break.
+        for (int c = 0; c < 256; c++) {
+            frequencies[c] += (unsigned long long)tables[0][c] + tables[1][c] + tables[2][c] + tables[3][c];
+        }
+        data += chunk;
+        size -= chunk;
+    }
+}
 
+/*
+    Terrible sort
+    --------------------------------------------------------
+    Antes era una selección O(256^2): buscar el más frecuente, copiarlo y
+    ponerlo en 0, hasta vaciar el alfabeto. Ahora es un qsort con el mismo
+    orden (mayor frecuencia primero, en empate el símbolo menor), y al igual
+    que antes deja las frecuencias del alfabeto global en 0.
     -------------------------------------------------------
-    You may say it's awful but it's linear, kinda
-
 */
 struct letter* terribleSort()
 {
-    struct letter* resultList; //Paso 1
     int amount = 0;
-    for(int i = 0; i<256; i++){
-        if(alphabet[i].frequency != 0)
-            amount ++;
-    }
-    resultList = (struct letter*)malloc(amount * sizeof(struct letter));
-    int resultArrayLeftIndex = 0;
-    
-
-    while(true){
-        int counter = 0;
-        struct letter biggestYet;
-        biggestYet.frequency = 0;
-        biggestYet.letter = 0;
-        
-        //
-        for(int i = 0; i < 256; i++){
-            long long unsigned int currentFreq = alphabet[i].frequency;
-            if(currentFreq > biggestYet.frequency)
-            {
-                biggestYet.frequency = currentFreq;
-                biggestYet.letter = alphabet[i].letter;
-            }
-        }
-        if(biggestYet.frequency == 0) break;
-
-        alphabet[biggestYet.letter].frequency = 0;
-
-        resultList[resultArrayLeftIndex] = biggestYet;
-        resultArrayLeftIndex ++;
-
-        //if(biggestYet.frequency == 0) break; Se manda el malloc usar esto
-        if(resultArrayLeftIndex > 255) break;
+    struct letter* resultList = sortLetters(alphabet, &amount);
+    for (int i = 0; i < 256; i++) {
+        alphabet[i].frequency = 0;
     }
-
     return resultList;
 }
 
@@ -124,55 +179,21 @@ struct letter* terribleSortFromFile(const char* filePath, int* out_size) {
     }
 
     // 2. Lee el archivo y cuenta las frecuencias en el alfabeto local
-    FILE *file = fopen(filePath, "r");
-    if (file == NULL) {
+    unsigned long long frequencies[256] = {0};
+    if (!countFileFrequencies(filePath, frequencies, NULL)) {
         perror("Error al abrir el archivo en terribleSortFromFile");
         return NULL; // Importante manejar el error
     }
-
-    int charAsciiValue;
-    while ((charAsciiValue = fgetc(file)) != EOF) {
-        unsigned char character = (unsigned char)charAsciiValue;
-        local_alphabet[(int)character].frequency++;
-    }
-    fclose(file);
-
-    //
-    int amount = 0;
     for (int i = 0; i < 256; i++) {
-        if (local_alphabet[i].frequency != 0) {
-            amount++;
-        }
+        local_alphabet[i].frequency = frequencies[i];
     }
-    *out_size = amount; // Devuelve el tamaño a través del puntero
 
-    struct letter* resultList = (struct letter*)malloc(amount * sizeof(struct letter));
+    // 3. Ordena de mayor a menor
+    struct letter* resultList = sortLetters(local_alphabet, out_size);
     if(resultList == NULL){
         perror("Error de memoria en terribleSortFromFile");
         return NULL;
     }
-
-    int resultArrayLeftIndex = 0;
-    while (resultArrayLeftIndex < amount) {
-        struct letter biggestYet = { .frequency = 0, .letter = 0 };
-        int biggest_index = -1;
-
-        for (int i = 0; i < 256; i++) {
-            if (local_alphabet[i].frequency > biggestYet.frequency) {
-                biggestYet = local_alphabet[i];
-                biggest_index = i;
-            }
-        }
-
-        if (biggest_index == -1) break; 
-
-        resultList[resultArrayLeftIndex] = biggestYet;
-        resultArrayLeftIndex++;
-
-
-        local_alphabet[biggest_index].frequency = 0;
-    }
-
     return resultList;
 }
 
@@ -180,17 +201,12 @@ struct letter* terribleSortFromFile(const char* filePath, int* out_size) {
 //Leer un archivo, para comenzar la compresión.
 void readTextFile(const char *fileName)
 {
-    FILE *file;
-    file = fopen(fileName, "r");
-    int charAsciiValue; 
-    if (file == NULL) { perror("Error, file not found\n"); return; }
+    unsigned long long frequencies[256] = {0};
+    if (!countFileFrequencies(fileName, frequencies, NULL)) { perror("Error, file not found\n"); return; }
 
-    while((charAsciiValue = fgetc(file)) != EOF) {
-        unsigned char character = (unsigned char)charAsciiValue;
-        addLetterFrequency(character);
+    for (int i = 0; i < 256; i++) {
+        alphabet[i].frequency += frequencies[i];
     }
-
-    fclose(file);
 }
 
 
@@ -285,575 +301,3624 @@ char* getCodeOfACharacter(char** huffmanCodes, unsigned char symbol){
 
 
 
-/**
- * @brief los parametros y el proposito de este procedimiento se explican solos.
- */
-void compressFile(const char *inputFileName, const char* outputFileName) {
-    FILE *inputFile = fopen(inputFileName, "r");
-    FILE *outputFile = fopen(outputFileName, "wb");
-
-    if (inputFile == NULL) {
-        perror("Error al abrir archivo de entrada");
-        return;
-    }
-    if (outputFile == NULL) {
-        perror("Error al crear archivo de salida");
-        fclose(inputFile);
-        return;
-    }
-
-    // --- Cálculo de Frecuencias  ---
-    long long total_chars = 0;
-    unsigned long long frequencies[256] = {0}; // Inicializar a cero
-    int charAsciiValue;
+//--------------------------------------------------------------------------//
+//                                                                          //
+//                 Entrada: mmap o buffer leído por bloques                 //
+//                                                                          //
+//--------------------------------------------------------------------------//
 
-    while ((charAsciiValue = fgetc(inputFile)) != EOF) {
-        frequencies[charAsciiValue]++;
-        total_chars++;
-    }
+#define INPUT_CHUNK_SIZE (1 << 20)
 
-    // --- Header para descomprimir los datos --
-    fwrite(&total_chars, sizeof(long long), 1, outputFile); //Cantidad total de caracteres a descomprimir
-    fwrite(frequencies, sizeof(unsigned long long), 256, outputFile); // Frecuencia,(para recuperar los códigos)
+// Lee todo lo que venga del descriptor en bloques de 1 MB. Solo queda para quien
+// pide una vista de un pipe: la compresión y el conteo de frecuencias de pipes y
+// stdin van por bloques de tamaño fijo (compressUnmappedInput, countFileFrequencies)
+static bool readAllChunks(int fd, struct inputView* view) {
+    size_t capacity = INPUT_CHUNK_SIZE;
+    size_t size = 0;
+    unsigned char* data = (unsigned char*)malloc(capacity);
+    if (data == NULL) return false;
 
-    // --- Generar Códigos de Huffman (basado en frecuencias locales) ---
-    int unique_chars_count = 0;
-    for (int i = 0; i < 256; i++) {
-        if (frequencies[i] > 0) {
-            unique_chars_count++;
+    while (true) {
+        if (size == capacity) {
+            capacity *= 2;
+            unsigned char* grown = (unsigned char*)realloc(data, capacity);
+            if (grown == NULL) { free(data); return false; }
+            data = grown;
         }
+        ssize_t got = read(fd, data + size, capacity - size);
+        if (got < 0) { free(data); return false; }
+        if (got == 0) break;
+        size += got;
     }
+    view->data = data;
+    view->size = size;
+    view->mapped = false;
+    return true;
+}
 
-    struct letter* letters = (struct letter*)malloc(unique_chars_count * sizeof(struct letter));
-    if (letters == NULL) {
-        perror("Fallo de memoria para la lista de letras");
-        fclose(inputFile); fclose(outputFile); return;
+/**
+ * @brief Abre el archivo de entrada como una vista en memoria. Los archivos
+ * regulares se mapean con mmap (una sola lectura de disco para contar
+ * frecuencias y codificar); "-" es stdin y, como los pipes, se lee por bloques.
+ * @return false si no se pudo abrir o leer.
+ */
+bool openInputView(const char* fileName, struct inputView* view) {
+    view->data = NULL;
+    view->size = 0;
+    view->mapped = false;
+
+    bool isStdin = strcmp(fileName, "-") == 0;
+    int fd = isStdin ? STDIN_FILENO : open(fileName, O_RDONLY);
+    if (fd < 0) {
+        return false;
     }
 
-    int current_index = 0;
-    for (int i = 0; i < 256; i++) {
-        if (frequencies[i] > 0) {
-            letters[current_index].letter = (unsigned char)i;
-            letters[current_index].frequency = frequencies[i];
-            current_index++;
+    struct stat st;
+    bool ok;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        ok = true;
+        if (st.st_size > 0) {
+            void* mapped = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                madvise(mapped, st.st_size, MADV_SEQUENTIAL);
+                view->data = (const unsigned char*)mapped;
+                view->size = st.st_size;
+                view->mapped = true;
+            } else {
+                ok = readAllChunks(fd, view);
+            }
         }
+    } else {
+        ok = readAllChunks(fd, view);
     }
 
-    struct treeNode* huffmanRoot = buildHuffmanTree(letters, unique_chars_count);
-    char** huffman_codes = (char**)calloc(256, sizeof(char*));
-    char path[256] = {0};
-    generateCodes(huffmanRoot, path, 0, huffman_codes);
+    if (!isStdin) close(fd);
+    return ok;
+}
 
-    // --- Escribir Datos Comprimidos ---
-    rewind(inputFile); // Volver al inicio del archivo de entrada para leerlo de nuevo
-    unsigned char byteBuffer = 0;
-    int bitCount = 0;
-
-    while ((charAsciiValue = fgetc(inputFile)) != EOF) {
-        char* code = huffman_codes[charAsciiValue];
-        for (int i = 0; code[i] != '\0'; i++) {
-            byteBuffer <<= 1;
-            if (code[i] == '1') {
-                byteBuffer |= 1;
-            }
-            bitCount++;
-            if (bitCount == 8) {
-                fputc(byteBuffer, outputFile);
-                bitCount = 0;
-                byteBuffer = 0;
-            }
+/**
+ * @brief Dice si la entrada es un archivo regular (mapeable y de tamaño conocido).
+ * "-" es stdin. Si no se puede consultar, se la trata como regular para que el
+ * error salga al abrirla.
+ */
+static bool isRegularInput(const char* fileName) {
+    struct stat st;
+    int result = (strcmp(fileName, "-") == 0) ? fstat(STDIN_FILENO, &st) : stat(fileName, &st);
+    return result != 0 || S_ISREG(st.st_mode);
+}
+
+/**
+ * @brief Cuenta las frecuencias de un archivo sin cargarlo entero si no hace
+ * falta: los regulares se mapean y el resto (stdin, pipes) se lee de a
+ * INPUT_CHUNK_SIZE con un solo buffer.
+ * @param frequencies Se suman los conteos (no se ponen en cero).
+ * @param bytes Si no es NULL, recibe la cantidad de bytes contados.
+ */
+bool countFileFrequencies(const char* fileName, unsigned long long* frequencies, long long* bytes) {
+    if (isRegularInput(fileName)) {
+        struct inputView view;
+        if (!openInputView(fileName, &view)) {
+            return false;
         }
+        countFrequenciesParallel(view.data, view.size, frequencies);
+        if (bytes != NULL) *bytes = (long long)view.size;
+        closeInputView(&view);
+        return true;
     }
 
-    if (bitCount > 0) {
-        byteBuffer <<= (8 - bitCount);
-        fputc(byteBuffer, outputFile);
+    bool isStdin = strcmp(fileName, "-") == 0;
+    int fd = isStdin ? STDIN_FILENO : open(fileName, O_RDONLY);
+    unsigned char* chunk = (fd >= 0) ? (unsigned char*)malloc(INPUT_CHUNK_SIZE) : NULL;
+    bool ok = chunk != NULL;
+    long long total = 0;
+    while (ok) {
+        ssize_t got = read(fd, chunk, INPUT_CHUNK_SIZE);
+        if (got < 0) ok = false;
+        if (got <= 0) break;
+        countFrequencies(chunk, (size_t)got, frequencies);
+        total += got;
     }
+    free(chunk);
+    if (fd >= 0 && !isStdin) close(fd);
+    if (bytes != NULL) *bytes = total;
+    return ok;
+}
 
-    //End, yay
-    fclose(inputFile);
-    fclose(outputFile);
-    free(letters);
-    freeTree(huffmanRoot);
-    liberarCodigos(huffman_codes); 
+void closeInputView(struct inputView* view) {
+    if (view->mapped) {
+        munmap((void*)view->data, view->size);
+    } else {
+        free((void*)view->data);
+    }
+    view->data = NULL;
+    view->size = 0;
+    view->mapped = false;
 }
 
 /**
- * @brief los parametros y el proposito de este procedimiento se explican solos.
+ * @brief Trae a memoria las páginas de una vista leyendo un byte por página,
+ * para que el hilo que la va a comprimir no se quede esperando al disco.
  */
-void compressFileParalel(const char *inputFileName, const char* outputFileName)
-{
-    FILE *inputFile;
-    FILE *outputFile;
-    inputFile = fopen(inputFileName, "r");
-    outputFile = fopen(outputFileName, "wb");
-
-    //... Ok, vamos a poner algo básico para errores
-    if (inputFile == NULL) {perror("Error, file not found\n"); return;}
-    if (outputFile == NULL) { perror("Error, output file is wrong somehow\n"); return;}
+void prefetchInputView(const struct inputView* view) {
+    if (!view->mapped) {
+        return; // Ya está completa en memoria
+    }
+    madvise((void*)view->data, view->size, MADV_WILLNEED);
+    long pageSize = sysconf(_SC_PAGESIZE);
+    volatile unsigned char sink = 0;
+    for (size_t i = 0; i < view->size; i += pageSize) {
+        sink ^= view->data[i];
+    }
+    (void)sink;
+}
 
-    //TotalChars es la cantidad total de caracteres
-    //El numero sirve para saber cuando parar con la descompresión.
-    long long total_chars = 0;
-    unsigned long long frequencies[256] = {0}; // Inicializar a cero
-    int charAsciiValue;
+//--------------------------------------------------------------------------//
+//                                                                          //
+//                Escritor de bits (acumulador de 64 bits)                  //
+//                                                                          //
+//--------------------------------------------------------------------------//
 
-    while ((charAsciiValue = fgetc(inputFile)) != EOF) {
-        frequencies[charAsciiValue]++;
-        total_chars++;
-    }
+#define ENCODE_BUFFER_SIZE (1 << 18)
 
-    fwrite(&total_chars, sizeof(long long), 1, outputFile);
-    fwrite(frequencies, sizeof(unsigned long long), 256, outputFile);
+// Escritor de bits: junta los códigos en un acumulador y vacía palabras de
+// 32 bits completas a un buffer grande, que se escribe con un solo fwrite.
+struct bitWriter {
+    FILE* file;
+    unsigned char buffer[ENCODE_BUFFER_SIZE];
+    size_t position;
+    unsigned long long flushed;     // Bytes ya escritos al archivo
+    unsigned long long accumulator; // Bits pendientes, alineados a la derecha
+    int count;                      // Bits pendientes (siempre < 32 entre llamadas)
+};
 
-    //Ok, a escribir el archivo.
-    char** codigos = obtenerCodigosParalel(inputFileName);
+static void initBitWriter(struct bitWriter* writer, FILE* file) {
+    writer->file = file;
+    writer->position = 0;
+    writer->flushed = 0;
+    writer->accumulator = 0;
+    writer->count = 0;
+}
 
-    unsigned char byteBuffer;//El caracter comprimido a escribir
-    int bitCount = 0;//Contar los BITS, si, BITS que se van llenando en el char
+// Cantidad de bits escritos hasta ahora (incluye los pendientes)
+static inline unsigned long long bitWriterPosition(const struct bitWriter* writer) {
+    return (writer->flushed + writer->position) * 8 + writer->count;
+}
 
-    rewind(inputFile); 
-        while((charAsciiValue = fgetc(inputFile)) != EOF) {
-            unsigned char character = (unsigned char)charAsciiValue;
-            char* code = codigos[character]; 
-            if (code == NULL) {perror("Lost a char worth of data, mission failed :(\n"); return;}
+static inline void flushBitWriterBuffer(struct bitWriter* writer) {
+    fwrite(writer->buffer, 1, writer->position, writer->file);
+    writer->flushed += writer->position;
+    writer->position = 0;
+}
 
-            //Un for para ir escribiendo en el buffer los bits
-            for (int i = 0; code[i] != '\0'; i++) {
-                byteBuffer <<= 1;
-                if (code[i] == '1') {
-                    byteBuffer |= 1; // Operación OR. 0010110 | 0000001 = 0010111
-                }
-                bitCount++;
-                if (bitCount == 8) {
-                    fputc(byteBuffer, outputFile);//Poner el caracter
-                    //Reset values
-                    bitCount = 0;
-                    byteBuffer = 0;
-                }
-            }
+// Agrega 'length' bits (hasta 32) al flujo, el más significativo primero
+static inline void putBits32(struct bitWriter* writer, unsigned long long bits, int length) {
+    writer->accumulator = (writer->accumulator << length) | bits;
+    writer->count += length;
+    if (writer->count >= 32) {
+        writer->count -= 32;
+        unsigned int word = (unsigned int)(writer->accumulator >> writer->count);
+        if (writer->position + 4 > ENCODE_BUFFER_SIZE) {
+            flushBitWriterBuffer(writer);
         }
-    //Resto
-    if (bitCount > 0) {
-        byteBuffer <<= (8 - bitCount);
-        fputc(byteBuffer, outputFile);
+        unsigned char* out = &writer->buffer[writer->position];
+        out[0] = (unsigned char)(word >> 24);
+        out[1] = (unsigned char)(word >> 16);
+        out[2] = (unsigned char)(word >> 8);
+        out[3] = (unsigned char)word;
+        writer->position += 4;
     }
+}
 
-    fclose(inputFile);
-    fclose(outputFile);
-    
-    // --- 5. Limpieza ---
-    fclose(inputFile);
-    fclose(outputFile);
-
-    // Asumiendo que tienes una función para liberar los códigos, como la que creamos antes
-    liberarCodigos(codigos); 
+static inline void putCode(struct bitWriter* writer, struct huffCode code) {
+    if (code.length > 32) {
+        putBits32(writer, code.bits >> 32, code.length - 32);
+        putBits32(writer, code.bits & 0xFFFFFFFFULL, 32);
+    } else {
+        putBits32(writer, code.bits, code.length);
+    }
 }
 
+// Escribe los bits pendientes (el último byte se rellena con ceros) y vacía el buffer
+static void finishBitWriter(struct bitWriter* writer) {
+    while (writer->count > 0) {
+        int take = (writer->count >= 8) ? 8 : writer->count;
+        unsigned char byte = (unsigned char)((writer->accumulator >> (writer->count - take)) << (8 - take));
+        if (writer->position == ENCODE_BUFFER_SIZE) {
+            flushBitWriterBuffer(writer);
+        }
+        writer->buffer[writer->position++] = byte;
+        writer->count -= take;
+    }
+    flushBitWriterBuffer(writer);
+}
 
 /**
- * @brief Obtiene el número total de caracteres que habían en el archivo comprimido
- * @param fileName El nombre del archivo comprimido.
- * @return El número total de caracteres, o -1 si hay un error.
+ * @brief Escribe las 256 longitudes de código: cada longitud distinta de cero
+ * ocupa un byte, y cada racha de ceros ocupa dos (0, largo de la racha - 1).
+ * Un texto típico con ~70 símbolos queda en menos de 100 bytes.
  */
-long long obtenerCantidadDeCaracteres(const char* fileName) {
-    FILE* file = fopen(fileName, "rb");
-    if (file == NULL) {
-        perror("Error al abrir el archivo");
-        return -1; // Devuelve un valor de error
+static void writeCodeLengths(FILE* outputFile, const unsigned char* lengths) {
+    int i = 0;
+    while (i < 256) {
+        if (lengths[i] != 0) {
+            fputc(lengths[i], outputFile);
+            i++;
+            continue;
+        }
+        int run = 0;
+        while (i + run < 256 && lengths[i + run] == 0) run++;
+        fputc(0, outputFile);
+        fputc(run - 1, outputFile);
+        i += run;
     }
+}
 
-    long long total_chars = 0;
-    // Lee 1 elemento del tamaño de un long long
-    if (fread(&total_chars, sizeof(long long), 1, file) != 1) {
-        fprintf(stderr, "Error al leer el conteo de caracteres del encabezado.\n");
-        fclose(file);
-        return -1; // Devuelve un valor de error
+/**
+ * @brief Lee las longitudes escritas por writeCodeLengths().
+ * @return false si el encabezado está incompleto o es inválido.
+ */
+static bool readCodeLengths(FILE* inputFile, unsigned char* lengths) {
+    int i = 0;
+    while (i < 256) {
+        int value = fgetc(inputFile);
+        if (value == EOF) return false;
+        if (value != 0) {
+            lengths[i++] = (unsigned char)value;
+            continue;
+        }
+        int run = fgetc(inputFile);
+        if (run == EOF || i + run + 1 > 256) return false;
+        for (int j = 0; j <= run; j++) lengths[i++] = 0;
     }
-
-    fclose(file);
-    return total_chars;
+    return true;
 }
 
-
 /**
- * @brief Obtiene la tabla de frecuencias del encabezado del archivo.
- * @param fileName El nombre del archivo comprimido.
- * @param frequencies Un puntero a un array de 256 'unsigned long long' donde se guardarán las frecuencias.
- * @return 'true' si la operación fue exitosa, 'false' si hubo un error.
+ * @brief Lee las longitudes de código (formato de writeCodeLengths) desde memoria.
+ * @param position Posición de lectura, se avanza hasta después de la tabla.
  */
-bool obtenerTablaDeFrecuencias(const char* fileName, unsigned long long* frequencies) {
-    FILE* file = fopen(fileName, "rb");
-    if (file == NULL) {
-        perror("Error al abrir el archivo");
-        return false;
+static bool parseCodeLengths(const unsigned char* data, size_t size, size_t* position, unsigned char* lengths) {
+    int i = 0;
+    while (i < 256) {
+        if (*position >= size) return false;
+        int value = data[(*position)++];
+        if (value != 0) {
+            lengths[i++] = (unsigned char)value;
+            continue;
+        }
+        if (*position >= size) return false;
+        int run = data[(*position)++];
+        if (i + run + 1 > 256) return false;
+        for (int j = 0; j <= run; j++) lengths[i++] = 0;
     }
+    return true;
+}
 
-    // SALTA los primeros bytes que corresponden al conteo de caracteres
-    // fseek(archivo, desplazamiento, desde_donde);
-    // SEEK_SET significa "desde el inicio del archivo".
-    if (fseek(file, sizeof(long long), SEEK_SET) != 0) {
-        fprintf(stderr, "Error al buscar la posición de la tabla de frecuencias.\n");
-        fclose(file);
-        return false;
+/**
+ * @brief Lee la marca del encabezado. Si el archivo no la tiene (formato viejo
+ * con tabla de frecuencias) vuelve al inicio.
+ * @return HUFF_MODE_CANONICAL u otro modo, 0 para el formato viejo, o -1 si no
+ * tiene marca y no se puede volver atrás (pipe).
+ */
+static int readHeaderMode(FILE* file) {
+    long start = ftell(file);
+    unsigned char header[HUFF_MAGIC_SIZE + 1];
+    if (fread(header, 1, sizeof(header), file) == sizeof(header) &&
+        memcmp(header, HUFF_MAGIC, HUFF_MAGIC_SIZE) == 0) {
+        return header[HUFF_MAGIC_SIZE];
     }
-
-    // Lee los 256 elementos de la tabla de frecuencias
-    if (fread(frequencies, sizeof(unsigned long long), 256, file) != 256) {
-        fprintf(stderr, "Error al leer la tabla de frecuencias del encabezado.\n");
-        fclose(file);
-        return false;
+    if (start < 0 || fseek(file, start, SEEK_SET) != 0) {
+        fprintf(stderr, "Error: el formato viejo solo se puede leer de un archivo (no de un pipe)\n");
+        return -1;
     }
+    return 0;
+}
 
-    fclose(file);
-    return true; // Éxito
+// Intervalo (en símbolos) de los puntos de sincronización; 0 = no se usan
+static size_t syncPointInterval = 0;
+
+/**
+ * @brief Activa los puntos de sincronización para archivos grandes: en vez de
+ * partirlos en bloques con tablas propias, se guarda un solo miembro con un
+ * índice de posiciones cada 'interval' bytes originales.
+ * @param interval Bytes entre puntos; 0 los desactiva.
+ */
+void setSyncPointInterval(size_t interval) {
+    syncPointInterval = (interval > HUFF_MAX_SYNC_INTERVAL) ? HUFF_MAX_SYNC_INTERVAL : interval;
 }
 
+//--------------------------------------------------------------------------//
+//                                                                          //
+//                  Modelo de contexto (orden 1): codificación              //
+//                                                                          //
+//--------------------------------------------------------------------------//
+
+// Si está activo, los miembros canónicos prueban el modelo de orden 1
+static bool contextModeling = false;
+
 /**
- * @brief Esta cosa obtiene los codigos desde un archivo.
- * @param compressedFileName es el archivo comprimido
- * @returns char** huffmanCodes, añlocados y todo.
+ * @brief Activa o desactiva el modo de contexto (HUFF_MODE_CONTEXT) para los
+ * archivos que se comprimen después. Cada miembro lo usa solo si sale más chico.
  */
-char** reconstruirCodigos(const char* compressedFileName) {
-    unsigned long long frequencies[256];
-    if (!obtenerTablaDeFrecuencias(compressedFileName, frequencies)) {
-        fprintf(stderr, "Error: No se pudo obtener la tabla de frecuencias. Abortando.\n");
-        return NULL; // Devuelve NULL para indicar un fallo.
-    }
+void setContextModeling(bool enabled) {
+    contextModeling = enabled;
+}
 
-    int size = 0;//Cantidad total de elementos mayores a 0
-    for (int i = 0; i < 256; i++) {
-        if (frequencies[i] > 0) {
-            size++;
+// Bytes que ocupa una tabla de longitudes con el formato de writeCodeLengths
+static size_t codeLengthsSize(const unsigned char* lengths) {
+    size_t bytes = 0;
+    int i = 0;
+    while (i < 256) {
+        if (lengths[i] != 0) {
+            bytes++;
+            i++;
+            continue;
         }
+        while (i < 256 && lengths[i] == 0) i++;
+        bytes += 2;
     }
+    return bytes;
+}
 
-    // Asignamos memoria para ese número exacto de caracteres.
-    struct letter* letters = (struct letter*)malloc(size * sizeof(struct letter));
-    if (letters == NULL) {
-        perror("Fallo al asignar memoria para la lista de letras");
-        return NULL;
+/**
+ * @brief Intenta escribir el miembro con el modelo de orden 1. Un contexto (byte
+ * anterior) recibe su propia tabla solo si lo que ahorra en datos paga sus
+ * longitudes en el encabezado; el resto comparte la clase 0.
+ * @return 1 si se escribió, 0 si no es más chico que orden 0 (no escribe nada), -1 si falló.
+ */
+static int encodeContextMember(const unsigned char* data, size_t size, FILE* outputFile) {
+    unsigned long long (*frequencies)[256] = calloc(256, sizeof(*frequencies));
+    unsigned char (*lengths)[256] = malloc(256 * sizeof(*lengths));      // Por contexto
+    unsigned char (*classLengths)[256] = malloc(256 * sizeof(*classLengths));
+    struct huffCode (*codes)[256] = malloc(256 * sizeof(*codes));
+    struct bitWriter* writer = (struct bitWriter*)malloc(sizeof(struct bitWriter));
+    int result = -1;
+    if (frequencies == NULL || lengths == NULL || classLengths == NULL || codes == NULL || writer == NULL) {
+        perror("Fallo de memoria para el modelo de contexto");
+        free(frequencies); free(lengths); free(classLengths); free(codes); free(writer);
+        return -1;
     }
 
-    // Llenamos la lista con los caracteres y sus frecuencias.
-    int currentIndex = 0;
-    for (int i = 0; i < 256; i++) {
-        if (frequencies[i] > 0) {
-            letters[currentIndex].letter = (unsigned char)i;
-            letters[currentIndex].frequency = frequencies[i];
-            currentIndex++;
-        }
+    unsigned char previous = 0;
+    for (size_t i = 0; i < size; i++) {
+        frequencies[previous][data[i]]++;
+        previous = data[i];
     }
 
-    // --- Pasos finales: Reconstruir el árbol de Huffman a partir de las frecuencias ---
+    // Orden 0 como referencia (tabla única + datos)
+    unsigned long long global[256] = { 0 };
+    for (int c = 0; c < 256; c++) {
+        for (int s = 0; s < 256; s++) global[s] += frequencies[c][s];
+    }
+    unsigned char globalLengths[256];
+    bool ok = codeLengthsFromFrequencies(global, globalLengths);
+    unsigned long long order0Bits = 8 * codeLengthsSize(globalLengths);
+    for (int s = 0; s < 256; s++) order0Bits += global[s] * globalLengths[s];
+
+    // Cada contexto que se paga solo recibe su propia tabla (a lo sumo 255 + la compartida)
+    bool own[256] = { false };
+    int ownCount = 0;
+    bool hasShared = false;
+    unsigned long long shared[256] = { 0 };
+    for (int c = 0; c < 256 && ok; c++) {
+        unsigned long long ownBits = 0, sharedBits = 0, count = 0;
+        for (int s = 0; s < 256; s++) count += frequencies[c][s];
+        if (count == 0) continue;
+        ok = codeLengthsFromFrequencies(frequencies[c], lengths[c]);
+        ownBits = 8 * codeLengthsSize(lengths[c]);
+        for (int s = 0; s < 256; s++) {
+            ownBits += frequencies[c][s] * lengths[c][s];
+            sharedBits += frequencies[c][s] * globalLengths[s];
+        }
+        if (ownBits < sharedBits && ownCount < 255) {
+            own[c] = true;
+            ownCount++;
+        } else {
+            hasShared = true;
+            for (int s = 0; s < 256; s++) shared[s] += frequencies[c][s];
+        }
+    }
+
+    // Clase 0 = compartida (si hace falta), después las propias en orden de contexto
+    unsigned char classOf[256] = { 0 };
+    int classCount = 0;
+    if (ok && hasShared) {
+        ok = codeLengthsFromFrequencies(shared, classLengths[classCount++]);
+    }
+    for (int c = 0; c < 256 && ok; c++) {
+        if (own[c]) {
+            classOf[c] = (unsigned char)classCount;
+            memcpy(classLengths[classCount++], lengths[c], 256);
+        }
+    }
+
+    // Costo exacto del modo de contexto, con encabezado
+    unsigned long long order1Bits = 8 * (sizeof(int) + codeLengthsSize(classOf));
+    for (int k = 0; k < classCount; k++) order1Bits += 8 * codeLengthsSize(classLengths[k]);
+    for (int c = 0; c < 256; c++) {
+        for (int s = 0; s < 256; s++) order1Bits += frequencies[c][s] * classLengths[classOf[c]][s];
+    }
+
+    if (ok && order1Bits >= order0Bits) {
+        result = 0;
+    } else if (ok) {
+        for (int k = 0; k < classCount && ok; k++) {
+            ok = assignCanonicalCodes(classLengths[k], codes[k]);
+        }
+        if (ok) {
+            long long total_chars = (long long)size;
+            fwrite(HUFF_MAGIC, 1, HUFF_MAGIC_SIZE, outputFile);
+            fputc(HUFF_MODE_CONTEXT, outputFile);
+            fwrite(&total_chars, sizeof(long long), 1, outputFile);
+            fwrite(&classCount, sizeof(int), 1, outputFile);
+            writeCodeLengths(outputFile, classOf); // Casi todo es clase 0: mismas rachas de ceros
+            for (int k = 0; k < classCount; k++) {
+                writeCodeLengths(outputFile, classLengths[k]);
+            }
+
+            initBitWriter(writer, outputFile);
+            previous = 0;
+            for (size_t i = 0; i < size; i++) {
+                putCode(writer, codes[classOf[previous]][data[i]]);
+                previous = data[i];
+            }
+            finishBitWriter(writer);
+            result = 1;
+        }
+    }
+
+    free(frequencies);
+    free(lengths);
+    free(classLengths);
+    free(codes);
+    free(writer);
+    return result;
+}
+
+/**
+ * @brief Escribe un miembro canónico completo (encabezado + datos). Si syncInterval
+ * no es 0, agrega el índice de puntos de sincronización (HUFF_MODE_INDEXED).
+ * @return false si no se pudieron generar los códigos.
+ */
+static bool encodeCanonicalMember(const unsigned char* data, size_t size, FILE* outputFile, size_t syncInterval) {
+    // Los puntos de sincronización necesitarían el byte anterior de cada tramo: solo orden 0
+    if (contextModeling && syncInterval == 0 && size > 0) {
+        int written = encodeContextMember(data, size, outputFile);
+        if (written != 0) {
+            return written > 0;
+        }
+    }
+
+    // --- Cálculo de Frecuencias  ---
+    long long total_chars = (long long)size;
+    unsigned long long frequencies[256] = {0}; // Inicializar a cero
+    countFrequenciesParallel(data, size, frequencies);
+
+    // --- Códigos canónicos: basta con guardar las longitudes ---
+    unsigned char lengths[256];
+    struct huffCode codes[256];
+    if (!codeLengthsFromFrequencies(frequencies, lengths) || !assignCanonicalCodes(lengths, codes)) {
+        return false;
+    }
+
+    int pointCount = 0;
+    long long* bitOffsets = NULL;
+    if (syncInterval > 0) {
+        pointCount = (int)((size + syncInterval - 1) / syncInterval);
+        bitOffsets = (long long*)malloc((pointCount > 0 ? pointCount : 1) * sizeof(long long));
+        if (bitOffsets == NULL) {
+            perror("Fallo de memoria para el índice de sincronización");
+            return false;
+        }
+    }
+
+    // --- Header para descomprimir los datos --
+    fwrite(HUFF_MAGIC, 1, HUFF_MAGIC_SIZE, outputFile);
+    fputc(syncInterval > 0 ? HUFF_MODE_INDEXED : HUFF_MODE_CANONICAL, outputFile);
+    fwrite(&total_chars, sizeof(long long), 1, outputFile); //Cantidad total de caracteres a descomprimir
+    writeCodeLengths(outputFile, lengths); // Longitudes (para recuperar los códigos)
+    if (syncInterval > 0) {
+        // El tamaño de los datos se conoce antes de codificar: frecuencia × longitud
+        unsigned long long totalBits = 0;
+        for (int i = 0; i < 256; i++) {
+            totalBits += frequencies[i] * lengths[i];
+        }
+        int interval = (int)syncInterval;
+        long long dataBytes = (long long)((totalBits + 7) / 8);
+        fwrite(&interval, sizeof(int), 1, outputFile);
+        fwrite(&dataBytes, sizeof(long long), 1, outputFile);
+    }
+
+    // --- Escribir Datos Comprimidos (segunda pasada sobre la misma memoria) ---
+    struct bitWriter* writer = (struct bitWriter*)malloc(sizeof(struct bitWriter));
+    if (writer == NULL) {
+        perror("Fallo de memoria para el escritor de bits");
+        free(bitOffsets);
+        return false;
+    }
+    initBitWriter(writer, outputFile);
+    if (syncInterval == 0) {
+        for (size_t i = 0; i < size; i++) {
+            putCode(writer, codes[data[i]]);
+        }
+    } else {
+        // Antes de cada tramo se anota dónde empieza en bits
+        for (int k = 0; k < pointCount; k++) {
+            size_t start = (size_t)k * syncInterval;
+            size_t end = (size - start < syncInterval) ? size : start + syncInterval;
+            bitOffsets[k] = (long long)bitWriterPosition(writer);
+            for (size_t i = start; i < end; i++) {
+                putCode(writer, codes[data[i]]);
+            }
+        }
+    }
+    finishBitWriter(writer);
+    free(writer);
+
+    if (syncInterval > 0) {
+        fwrite(&pointCount, sizeof(int), 1, outputFile);
+        fwrite(bitOffsets, sizeof(long long), pointCount, outputFile);
+        free(bitOffsets);
+    }
+    return true;
+}
+
+// Si está activa, los miembros pasan por BWT + MTF + rachas de ceros antes de Huffman
+static bool blockTransform = false;
+
+/**
+ * @brief Activa o desactiva la transformada previa (HUFF_MODE_TRANSFORM) para
+ * los archivos que se comprimen después; se descomprimen igual sin activarla.
+ */
+void setBlockTransform(bool enabled) {
+    blockTransform = enabled;
+}
+
+// Bytes que ocuparía el miembro canónico de orden 0 (encabezado + datos), sin codificarlo
+static unsigned long long canonicalMemberSize(const unsigned char* data, size_t size) {
+    unsigned long long frequencies[256] = { 0 };
+    unsigned char lengths[256];
+    countFrequenciesParallel(data, size, frequencies);
+    if (!codeLengthsFromFrequencies(frequencies, lengths)) {
+        return ULLONG_MAX;
+    }
+    unsigned long long bits = 0;
+    for (int i = 0; i < 256; i++) {
+        bits += frequencies[i] * lengths[i];
+    }
+    return HUFF_MAGIC_SIZE + 1 + sizeof(long long) + codeLengthsSize(lengths) + (bits + 7) / 8;
+}
+
+//--------------------------------------------------------------------------//
+//                                                                          //
+//                      LZ77 + Huffman: codificación                        //
+//                                                                          //
+//--------------------------------------------------------------------------//
+
+// Nivel de LZ77 (0 = no se usa)
+static int lzLevel = 0;
+
+/**
+ * @brief Cambia el nivel de LZ77 para los archivos que se comprimen después:
+ * 0 lo desactiva, 1 es el más rápido y HUFF_LZ_MAX_LEVEL el que más comprime.
+ * @return false si el nivel está fuera de rango.
+ */
+bool setLzLevel(int level) {
+    if (level < 0 || level > HUFF_LZ_MAX_LEVEL) {
+        return false;
+    }
+    lzLevel = level;
+    return true;
+}
+
+// Escribe un valor como su código (tabla 'table') y los bits extra
+static inline void putLzValue(struct bitWriter* writer, const struct huffCode* codes, unsigned int value) {
+    int extraBits;
+    unsigned char code = lzValueCode(value, &extraBits);
+    putCode(writer, codes[code]);
+    if (extraBits > 0) {
+        putBits32(writer, value & ((1u << extraBits) - 1), extraBits);
+    }
+}
+
+static inline void countLzValue(unsigned long long* frequencies, unsigned long long* extra, unsigned int value) {
+    int extraBits;
+    frequencies[lzValueCode(value, &extraBits)]++;
+    *extra += extraBits;
+}
+
+/**
+ * @brief Intenta escribir el miembro como LZ77 + Huffman (HUFF_MODE_LZ).
+ * Las frecuencias de las cuatro tablas salen de las secuencias, así que el
+ * tamaño exacto se conoce antes de escribir y se compara con el de orden 0.
+ * @return 1 si se escribió, 0 si no es más chico (no escribe nada), -1 si falló.
+ */
+static int encodeLzMember(const unsigned char* data, size_t size, FILE* outputFile) {
+    struct lzSequence* sequences;
+    size_t count;
+    if (!lzFindSequences(data, size, lzLevel, &sequences, &count)) {
+        perror("Fallo de memoria para LZ77");
+        return -1;
+    }
+
+    // Tablas: 0 = literales, 1 = cantidad de literales, 2 = largos, 3 = distancias
+    unsigned long long frequencies[HUFF_LZ_TABLES][256];
+    unsigned char lengths[HUFF_LZ_TABLES][256];
+    struct huffCode codes[HUFF_LZ_TABLES][256];
+    unsigned long long extraBits = 0;
+    memset(frequencies, 0, sizeof(frequencies));
+    size_t position = 0;
+    for (size_t i = 0; i < count; i++) {
+        countFrequencies(data + position, sequences[i].literals, frequencies[0]);
+        position += sequences[i].literals;
+        countLzValue(frequencies[1], &extraBits, sequences[i].literals);
+        if (sequences[i].matchLength > 0) {
+            countLzValue(frequencies[2], &extraBits, sequences[i].matchLength - HUFF_LZ_MIN_MATCH);
+            countLzValue(frequencies[3], &extraBits, sequences[i].distance - 1);
+            position += sequences[i].matchLength;
+        }
+    }
+
+    bool ok = true;
+    unsigned long long bits = extraBits;
+    size_t headerBytes = HUFF_MAGIC_SIZE + 1 + sizeof(long long);
+    for (int t = 0; t < HUFF_LZ_TABLES && ok; t++) {
+        // Una tabla vacía igual necesita un código para poder armarse
+        bool empty = true;
+        for (int s = 0; s < 256 && empty; s++) empty = frequencies[t][s] == 0;
+        if (empty) frequencies[t][0] = 1;
+        ok = codeLengthsFromFrequencies(frequencies[t], lengths[t]) && assignCanonicalCodes(lengths[t], codes[t]);
+        if (empty) frequencies[t][0] = 0;
+        headerBytes += codeLengthsSize(lengths[t]);
+        for (int s = 0; s < 256; s++) bits += frequencies[t][s] * lengths[t][s];
+    }
+
+    int result = ok ? 0 : -1;
+    if (ok && headerBytes + (bits + 7) / 8 < canonicalMemberSize(data, size)) {
+        struct bitWriter* writer = (struct bitWriter*)malloc(sizeof(struct bitWriter));
+        if (writer == NULL) {
+            perror("Fallo de memoria para el escritor de bits");
+            result = -1;
+        } else {
+            long long total_chars = (long long)size;
+            fwrite(HUFF_MAGIC, 1, HUFF_MAGIC_SIZE, outputFile);
+            fputc(HUFF_MODE_LZ, outputFile);
+            fwrite(&total_chars, sizeof(long long), 1, outputFile);
+            for (int t = 0; t < HUFF_LZ_TABLES; t++) {
+                writeCodeLengths(outputFile, lengths[t]);
+            }
+
+            initBitWriter(writer, outputFile);
+            position = 0;
+            for (size_t i = 0; i < count; i++) {
+                putLzValue(writer, codes[1], sequences[i].literals);
+                for (unsigned int k = 0; k < sequences[i].literals; k++) {
+                    putCode(writer, codes[0][data[position++]]);
+                }
+                if (sequences[i].matchLength > 0) {
+                    putLzValue(writer, codes[2], sequences[i].matchLength - HUFF_LZ_MIN_MATCH);
+                    putLzValue(writer, codes[3], sequences[i].distance - 1);
+                    position += sequences[i].matchLength;
+                }
+            }
+            finishBitWriter(writer);
+            free(writer);
+            result = 1;
+        }
+    }
+    free(sequences);
+    return result;
+}
+
+/**
+ * @brief Escribe el miembro transformado: BWT por bloques (en paralelo), MTF y
+ * rachas de ceros, y el resultado como un miembro canónico (o de contexto) interno.
+ * Si con la transformada sale más grande (datos sin repeticiones) escribe el
+ * miembro sin transformar.
+ * @return false si falta memoria o no se pudieron generar los códigos.
+ */
+static bool encodeTransformedMember(const unsigned char* data, size_t size, FILE* outputFile) {
+    int blockCount = transformBlockCount(size);
+    unsigned char* sorted = (unsigned char*)malloc(size);
+    unsigned char* runs = (unsigned char*)malloc(ZERO_RUN_BOUND(size));
+    int* primary = (int*)malloc(blockCount * sizeof(int));
+    char* inner = NULL;
+    size_t innerSize = 0;
+
+    bool ok = sorted != NULL && runs != NULL && primary != NULL &&
+              bwtForwardBlocks(data, size, sorted, primary);
+    if (!ok) {
+        perror("Fallo de memoria para la transformada");
+    }
+    if (ok) {
+        mtfEncode(sorted, size);
+        long long transformed = (long long)zeroRunEncode(sorted, size, runs);
+
+        // El miembro interno va a memoria para saber su tamaño antes de escribirlo
+        FILE* memory = open_memstream(&inner, &innerSize);
+        ok = memory != NULL && encodeCanonicalMember(runs, transformed, memory, 0);
+        if (memory != NULL) fclose(memory);
+
+        long long rest = sizeof(long long) + sizeof(int) + blockCount * sizeof(int) +
+                         sizeof(long long) + innerSize;
+        if (ok && HUFF_MAGIC_SIZE + 1 + sizeof(long long) + rest >= canonicalMemberSize(data, size)) {
+            ok = encodeCanonicalMember(data, size, outputFile, 0);
+        } else if (ok) {
+            long long total_chars = (long long)size;
+            fwrite(HUFF_MAGIC, 1, HUFF_MAGIC_SIZE, outputFile);
+            fputc(HUFF_MODE_TRANSFORM, outputFile);
+            fwrite(&rest, sizeof(long long), 1, outputFile);
+            fwrite(&total_chars, sizeof(long long), 1, outputFile);
+            fwrite(&blockCount, sizeof(int), 1, outputFile);
+            fwrite(primary, sizeof(int), blockCount, outputFile);
+            fwrite(&transformed, sizeof(long long), 1, outputFile);
+            fwrite(inner, 1, innerSize, outputFile);
+        }
+    }
+
+    free(sorted);
+    free(runs);
+    free(primary);
+    free(inner);
+    return ok;
+}
+
+//--------------------------------------------------------------------------//
+//                                                                          //
+//                  Diccionarios entrenados (tablas fijas)                  //
+//                                                                          //
+//--------------------------------------------------------------------------//
+
+// Diccionario cargado con loadDictionary; sirve para comprimir y para descomprimir
+static struct {
+    bool loaded;
+    unsigned int id;
+    unsigned char lengths[256];
+    struct huffCode codes[256];
+} dictionary;
+
+/**
+ * @brief Arma un diccionario con los archivos de una muestra (recorrida entera):
+ * suma sus frecuencias y guarda las longitudes de código. Todos los bytes reciben
+ * un código, aunque no aparezcan en la muestra, para poder codificar cualquier archivo.
+ * @return false si la muestra no se puede leer o el archivo no se puede escribir.
+ */
+bool trainDictionary(const char* sampleDir, const char* dictionaryFile) {
+    int fileCount;
+    struct walkEntry* files = walkDirectory(sampleDir, &fileCount);
+    if (files == NULL) {
+        return false;
+    }
+    unsigned long long frequencies[256];
+    for (int i = 0; i < 256; i++) frequencies[i] = 1;
+    long long sampleBytes = 0;
+    for (int i = 0; i < fileCount; i++) {
+        long long bytes;
+        if (!countFileFrequencies(files[i].path, frequencies, &bytes)) {
+            fprintf(stderr, "Error al abrir archivo de entrada: %s\n", files[i].path);
+            continue;
+        }
+        sampleBytes += bytes;
+    }
+    freeWalkEntries(files, fileCount);
+
+    unsigned char lengths[256];
+    if (!codeLengthsFromFrequencies(frequencies, lengths)) {
+        return false;
+    }
+    unsigned int id = crc32Update(0, lengths, sizeof(lengths));
+    FILE* output = fopen(dictionaryFile, "wb");
+    if (output == NULL) {
+        perror("Error al crear el diccionario");
+        return false;
+    }
+    fwrite(HUFF_DICTIONARY_MAGIC, 1, HUFF_DICTIONARY_MAGIC_SIZE, output);
+    fwrite(&id, sizeof(unsigned int), 1, output);
+    writeCodeLengths(output, lengths);
+    bool ok = fclose(output) == 0;
+    if (ok) {
+        printf("Diccionario %08x entrenado con %d archivos (%lld bytes): %s\n", id, fileCount, sampleBytes,
+               dictionaryFile);
+    }
+    return ok;
+}
+
+/**
+ * @brief Carga un diccionario para los archivos que se comprimen o descomprimen después.
+ * @return false si el archivo no es un diccionario válido (el id no coincide).
+ */
+bool loadDictionary(const char* dictionaryFile) {
+    FILE* input = fopen(dictionaryFile, "rb");
+    if (input == NULL) {
+        perror("Error al abrir el diccionario");
+        return false;
+    }
+    char magic[HUFF_DICTIONARY_MAGIC_SIZE];
+    unsigned int id;
+    unsigned char lengths[256];
+    bool ok = fread(magic, 1, HUFF_DICTIONARY_MAGIC_SIZE, input) == HUFF_DICTIONARY_MAGIC_SIZE &&
+              memcmp(magic, HUFF_DICTIONARY_MAGIC, HUFF_DICTIONARY_MAGIC_SIZE) == 0 &&
+              fread(&id, sizeof(unsigned int), 1, input) == 1 && readCodeLengths(input, lengths) &&
+              crc32Update(0, lengths, sizeof(lengths)) == id && assignCanonicalCodes(lengths, dictionary.codes);
+    fclose(input);
+    if (!ok) {
+        fprintf(stderr, "Error: %s no es un diccionario válido\n", dictionaryFile);
+        return false;
+    }
+    for (int i = 0; i < 256; i++) {
+        if (lengths[i] == 0) {
+            fprintf(stderr, "Error: el diccionario no tiene código para el byte %d\n", i);
+            return false;
+        }
+    }
+    memcpy(dictionary.lengths, lengths, sizeof(lengths));
+    dictionary.id = id;
+    dictionary.loaded = true;
+    return true;
+}
+
+// Escribe el miembro con los códigos del diccionario (HUFF_MODE_DICTIONARY)
+static bool encodeDictionaryMember(const unsigned char* data, size_t size, FILE* outputFile) {
+    struct bitWriter* writer = (struct bitWriter*)malloc(sizeof(struct bitWriter));
+    if (writer == NULL) {
+        perror("Fallo de memoria para el escritor de bits");
+        return false;
+    }
+    long long total_chars = (long long)size;
+    fwrite(HUFF_MAGIC, 1, HUFF_MAGIC_SIZE, outputFile);
+    fputc(HUFF_MODE_DICTIONARY, outputFile);
+    fwrite(&total_chars, sizeof(long long), 1, outputFile);
+    fwrite(&dictionary.id, sizeof(unsigned int), 1, outputFile);
+    initBitWriter(writer, outputFile);
+    for (size_t i = 0; i < size; i++) {
+        putCode(writer, dictionary.codes[data[i]]);
+    }
+    finishBitWriter(writer);
+    free(writer);
+    return true;
+}
+
+// Los archivos chicos usan el diccionario cargado sin contar frecuencias
+static bool dictionaryDirect(size_t size) {
+    return dictionary.loaded && size <= HUFF_DICTIONARY_DIRECT_MAX;
+}
+
+/**
+ * @brief Con un diccionario cargado, decide si el miembro lo usa: los archivos
+ * chicos siempre (sin contar frecuencias); los demás solo si sale más chico que
+ * con su propia tabla.
+ */
+static bool useDictionary(const unsigned char* data, size_t size) {
+    if (!dictionary.loaded) {
+        return false;
+    }
+    if (dictionaryDirect(size)) {
+        return true;
+    }
+    unsigned long long frequencies[256] = { 0 };
+    countFrequenciesParallel(data, size, frequencies);
+    unsigned long long bits = 0;
+    for (int i = 0; i < 256; i++) {
+        bits += frequencies[i] * dictionary.lengths[i];
+    }
+    size_t dictionarySize = HUFF_MAGIC_SIZE + 1 + sizeof(long long) + sizeof(unsigned int) + (bits + 7) / 8;
+    return dictionarySize < canonicalMemberSize(data, size);
+}
+
+//--------------------------------------------------------------------------//
+//                                                                          //
+//              Miembros guardados sin comprimir (incompresibles)           //
+//                                                                          //
+//--------------------------------------------------------------------------//
+
+/**
+ * @brief Copia count bytes de inFd (desde inOffset) a la posición actual de outFd
+ * sin pasar por memoria del proceso: copy_file_range, sendfile si no se puede (otro
+ * sistema de archivos, salida a un pipe) y pread/write como último recurso.
+ */
+static bool copyFileBytes(int inFd, long long inOffset, int outFd, long long count) {
+    off_t offset = (off_t)inOffset;
+    while (count > 0) {
+        ssize_t copied = copy_file_range(inFd, &offset, outFd, NULL, (size_t)count, 0);
+        if (copied <= 0) break;
+        count -= copied;
+    }
+    while (count > 0) {
+        ssize_t copied = sendfile(outFd, inFd, &offset, (size_t)count);
+        if (copied <= 0) break;
+        count -= copied;
+    }
+    unsigned char buffer[64 * 1024];
+    while (count > 0) {
+        size_t chunk = (count < (long long)sizeof(buffer)) ? (size_t)count : sizeof(buffer);
+        ssize_t got = pread(inFd, buffer, chunk, offset);
+        if (got <= 0) return false;
+        for (ssize_t written = 0; written < got; ) {
+            ssize_t put = write(outFd, buffer + written, got - written);
+            if (put <= 0) return false;
+            written += put;
+        }
+        offset += got;
+        count -= got;
+    }
+    return true;
+}
+
+/**
+ * @brief Decide con el histograma si vale la pena codificar: la entropía de orden 0
+ * es el mínimo al que puede llegar Huffman, así que si ni con ella (más una longitud
+ * por símbolo) se ahorra 1/HUFF_STORED_MIN_SAVING, el miembro se guarda tal cual.
+ * Los archivos grandes se estiman con HUFF_STORED_SAMPLE_CHUNKS tramos repartidos,
+ * así los ya comprimidos (.gz, .jpg) no se leen enteros. Se decide antes de elegir
+ * el modo, así la transformada o LZ77 no corren sobre datos que no van a achicar.
+ */
+static bool isIncompressible(const unsigned char* data, size_t size) {
+    // Si el único modo posible es el diccionario directo no se cuenta nada: si
+    // el miembro no achica, igual se guarda después de codificarlo
+    bool onlyDictionary = dictionaryDirect(size) && lzLevel == 0 &&
+                          !(blockTransform && size >= HUFF_TRANSFORM_MIN_SIZE);
+    if (size == 0 || onlyDictionary) {
+        return false;
+    }
+    unsigned long long frequencies[256] = { 0 };
+    size_t sampled = 0;
+    if (size <= (size_t)HUFF_STORED_SAMPLE_CHUNK * HUFF_STORED_SAMPLE_CHUNKS) {
+        countFrequencies(data, size, frequencies);
+        sampled = size;
+    } else {
+        size_t stride = size / HUFF_STORED_SAMPLE_CHUNKS;
+        for (int k = 0; k < HUFF_STORED_SAMPLE_CHUNKS; k++) {
+            countFrequencies(data + k * stride, HUFF_STORED_SAMPLE_CHUNK, frequencies);
+        }
+        sampled = (size_t)HUFF_STORED_SAMPLE_CHUNK * HUFF_STORED_SAMPLE_CHUNKS;
+    }
+
+    double entropyBits = 0;
+    int symbols = 0;
+    for (int i = 0; i < 256; i++) {
+        if (frequencies[i] == 0) continue;
+        double p = (double)frequencies[i] / sampled;
+        entropyBits -= p * log2(p);
+        symbols++;
+    }
+    double estimated = entropyBits * size / 8 + symbols;
+    return estimated >= (double)size - (double)size / HUFF_STORED_MIN_SAVING;
+}
+
+#define STORED_HEADER_SIZE (HUFF_MAGIC_SIZE + 1 + sizeof(long long))
+
+// Encabezado de HUFF_MODE_STORED; los datos van después tal cual
+static void storedHeader(unsigned char* header, size_t size) {
+    long long total_chars = (long long)size;
+    memcpy(header, HUFF_MAGIC, HUFF_MAGIC_SIZE);
+    header[HUFF_MAGIC_SIZE] = HUFF_MODE_STORED;
+    memcpy(header + HUFF_MAGIC_SIZE + 1, &total_chars, sizeof(long long));
+}
+
+static void writeStoredHeader(FILE* outputFile, size_t size) {
+    unsigned char header[STORED_HEADER_SIZE];
+    storedHeader(header, size);
+    fwrite(header, 1, STORED_HEADER_SIZE, outputFile);
+}
+
+/**
+ * @brief Guarda un archivo incompresible sin comprimir (HUFF_MODE_STORED). Los datos
+ * se copian dentro del kernel con copyFileBytes; si la vista no viene de un archivo
+ * que se pueda volver a abrir (stdin) se escriben desde memoria.
+ * @param checksum Si no es NULL, recibe el CRC32 del miembro (encabezado + datos),
+ * calculado sobre la vista de entrada: esa pasada sí lee todos los datos, así que
+ * la copia en el kernel solo se ahorra la escritura desde memoria, no la lectura.
+ */
+static bool storeFileMember(const char* inputFileName, const struct inputView* view, FILE* outputFile,
+                            unsigned int* checksum) {
+    if (checksum != NULL) {
+        unsigned char header[STORED_HEADER_SIZE];
+        storedHeader(header, view->size);
+        *checksum = crc32Update(crc32Update(0, header, STORED_HEADER_SIZE), view->data, view->size);
+    }
+    writeStoredHeader(outputFile, view->size);
+    int fd = view->mapped ? open(inputFileName, O_RDONLY | O_CLOEXEC) : -1;
+    if (fd < 0) {
+        return fwrite(view->data, 1, view->size, outputFile) == view->size;
+    }
+    bool ok = fflush(outputFile) == 0 && copyFileBytes(fd, 0, fileno(outputFile), (long long)view->size);
+    close(fd);
+    // copy_file_range movió el descriptor por debajo del FILE*
+    off_t end = lseek(fileno(outputFile), 0, SEEK_CUR);
+    if (end >= 0 && fseek(outputFile, end, SEEK_SET) != 0) {
+        ok = false;
+    }
+    return ok;
+}
+
+// Elige cómo se codifica un miembro según las opciones activas
+static bool encodeMemberData(const unsigned char* data, size_t size, FILE* outputFile, size_t syncInterval) {
+    if (blockTransform && syncInterval == 0 && size >= HUFF_TRANSFORM_MIN_SIZE) {
+        return encodeTransformedMember(data, size, outputFile);
+    }
+    if (lzLevel > 0 && syncInterval == 0 && size >= HUFF_LZ_MIN_MATCH) {
+        int written = encodeLzMember(data, size, outputFile);
+        if (written != 0) {
+            return written > 0;
+        }
+    }
+    if (syncInterval == 0 && useDictionary(data, size)) {
+        return encodeDictionaryMember(data, size, outputFile);
+    }
+    return encodeCanonicalMember(data, size, outputFile, syncInterval);
+}
+
+/**
+ * @brief Escribe el miembro guardado si incompressible (la decisión de isIncompressible,
+ * tomada una sola vez por quien llama); si no, lo codifica y, si el resultado no es
+ * más chico que guardarlo, vuelve atrás y lo guarda. Para volver atrás la salida tiene
+ * que permitir fseek (archivo o open_memstream, cuyo tamaño es la posición final).
+ */
+static bool encodeOrStoreMember(const unsigned char* data, size_t size, FILE* outputFile, size_t syncInterval,
+                                bool incompressible) {
+    if (incompressible) {
+        writeStoredHeader(outputFile, size);
+        return size == 0 || fwrite(data, 1, size, outputFile) == size; // Vacío: data puede ser NULL
+    }
+    long start = ftell(outputFile);
+    if (!encodeMemberData(data, size, outputFile, syncInterval)) {
+        return false;
+    }
+    long end = ftell(outputFile);
+    if (start < 0 || end < 0 || (unsigned long long)(end - start) <= STORED_HEADER_SIZE + size ||
+        fseek(outputFile, start, SEEK_SET) != 0) {
+        return true;
+    }
+    writeStoredHeader(outputFile, size);
+    bool ok = (size == 0 || fwrite(data, 1, size, outputFile) == size) && fflush(outputFile) == 0;
+    if (ok && fileno(outputFile) >= 0 && ftruncate(fileno(outputFile), ftell(outputFile)) != 0) {
+        perror("Error al recortar el archivo de salida");
+        ok = false;
+    }
+    return ok;
+}
+
+/**
+ * @brief Comprime un bloque de memoria y escribe el miembro completo
+ * (encabezado + datos) en outputFile; si no se achica, lo guarda sin comprimir.
+ * @return false si no se pudieron generar los códigos.
+ */
+bool encodeMember(const unsigned char* data, size_t size, FILE* outputFile) {
+    return encodeOrStoreMember(data, size, outputFile, 0, isIncompressible(data, size));
+}
+
+/**
+ * @brief Comprime una entrada que no se puede mapear (stdin, pipe) por tramas de
+ * HUFF_MODE_STREAM, con un solo buffer de HUFF_BLOCK_SIZE: la memoria no depende
+ * del tamaño de la entrada y cada trama se escribe apenas se llena.
+ */
+static bool compressUnmappedInput(const char* inputFileName, FILE* outputFile, long long* originalSize) {
+    bool isStdin = strcmp(inputFileName, "-") == 0;
+    FILE* inputFile = isStdin ? stdin : fopen(inputFileName, "rb");
+    if (inputFile == NULL) {
+        perror("Error al abrir archivo de entrada");
+        return false;
+    }
+    long long total = 0;
+    bool ok = compressStreamingCounted(inputFile, outputFile, &total);
+    if (!isStdin) fclose(inputFile);
+    if (originalSize != NULL) {
+        *originalSize = total;
+    }
+    return ok;
+}
+
+/**
+ * @brief Como compressFileToStream; si el miembro se guardó sin comprimir, su CRC32
+ * sale de la vista de entrada y queda en *storedChecksum.
+ * @param storedChecksumKnown Si no es NULL, recibe si *storedChecksum es válido.
+ */
+static bool compressFileMember(const char* inputFileName, FILE* outputFile, long long* originalSize,
+                               bool* storedChecksumKnown, unsigned int* storedChecksum) {
+    if (!isRegularInput(inputFileName)) {
+        if (storedChecksumKnown != NULL) *storedChecksumKnown = false;
+        return compressUnmappedInput(inputFileName, outputFile, originalSize);
+    }
+    struct inputView view;
+    if (!openInputView(inputFileName, &view)) {
+        perror("Error al abrir archivo de entrada");
+        return false;
+    }
+    if (storedChecksumKnown != NULL) *storedChecksumKnown = false;
+    if (originalSize != NULL) {
+        *originalSize = (long long)view.size;
+    }
+
+    // Los archivos grandes se parten en bloques que se comprimen en paralelo,
+    // o llevan puntos de sincronización si así se pidió
+    bool ok;
+    if (isIncompressible(view.data, view.size)) {
+        ok = storeFileMember(inputFileName, &view, outputFile, storedChecksum);
+        if (storedChecksumKnown != NULL) *storedChecksumKnown = true;
+    } else if (view.size < HUFF_BLOCK_THRESHOLD) {
+        ok = encodeOrStoreMember(view.data, view.size, outputFile, 0, false);
+    } else if (syncPointInterval > 0) {
+        ok = encodeOrStoreMember(view.data, view.size, outputFile, syncPointInterval, false);
+    } else {
+        ok = compressBlocks(view.data, view.size, outputFile);
+    }
+    if (!ok) {
+        fprintf(stderr, "Error al generar los códigos de Huffman para: %s\n", inputFileName);
+    }
+    closeInputView(&view);
+    return ok;
+}
+
+/**
+ * @brief Dice si compressFileToStream guardaría esta vista como contenedor por bloques
+ * (grande, compresible y sin puntos de sincronización). Así un pool propio puede
+ * repartir los bloques como tareas y armar el mismo miembro.
+ */
+bool fileMemberUsesBlocks(const struct inputView* view) {
+    return view->size >= HUFF_BLOCK_THRESHOLD && syncPointInterval == 0 &&
+           !isIncompressible(view->data, view->size);
+}
+
+/**
+ * @brief Comprime un archivo y escribe el miembro en la posición actual de outputFile,
+ * sin pasar por archivos temporales. Los archivos grandes se parten en bloques.
+ * @param outputFile Debe permitir fseek (el índice de bloques se completa al final).
+ * @param originalSize Si no es NULL, recibe el tamaño del archivo original.
+ * @return true si la compresión fue exitosa.
+ */
+bool compressFileToStream(const char* inputFileName, FILE* outputFile, long long* originalSize) {
+    return compressFileMember(inputFileName, outputFile, originalSize, NULL, NULL);
+}
+/**
+ * @brief Comprime un rango de memoria a un miembro canónico en un buffer nuevo.
+ * @param out Recibe el buffer (liberar con free); NULL si hubo error.
+ * @param outSize Recibe el tamaño del buffer.
+ * @return true si la compresión fue exitosa.
+ */
+bool encodeMemberToMemory(const unsigned char* data, size_t size, unsigned char** out, size_t* outSize) {
+    char* buffer = NULL;
+    size_t bufferSize = 0;
+    FILE* memory = open_memstream(&buffer, &bufferSize);
+    bool ok = memory != NULL && encodeMember(data, size, memory);
+    if (memory != NULL) fclose(memory);
+
+    if (!ok) {
+        free(buffer);
+        buffer = NULL;
+        bufferSize = 0;
+    }
+    *out = (unsigned char*)buffer;
+    *outSize = bufferSize;
+    return ok;
+}
+
+/**
+ * @brief Comprime un archivo completo a un buffer en memoria (un solo miembro
+ * canónico, sin bloques), para que otro hilo o proceso lo escriba después.
+ * @param data Recibe el buffer (liberar con free).
+ * @param size Recibe el tamaño del buffer.
+ * @param originalSize Recibe el tamaño del archivo original.
+ * @return true si la compresión fue exitosa.
+ */
+bool compressFileToMemory(const char* inputFileName, unsigned char** data, size_t* size, long long* originalSize) {
+    *data = NULL;
+    *size = 0;
+    if (!isRegularInput(inputFileName)) {
+        // Un pipe se comprime por tramas directo al buffer de salida
+        char* buffer = NULL;
+        size_t bufferSize = 0;
+        FILE* memory = open_memstream(&buffer, &bufferSize);
+        bool ok = memory != NULL && compressUnmappedInput(inputFileName, memory, originalSize);
+        if (memory != NULL) fclose(memory);
+        if (!ok) {
+            free(buffer);
+            return false;
+        }
+        *data = (unsigned char*)buffer;
+        *size = bufferSize;
+        return true;
+    }
+    struct inputView view;
+    if (!openInputView(inputFileName, &view)) {
+        perror("Error al abrir archivo de entrada");
+        return false;
+    }
+    *originalSize = (long long)view.size;
+
+    bool ok = encodeMemberToMemory(view.data, view.size, data, size);
+    closeInputView(&view);
+    if (!ok) {
+        fprintf(stderr, "Error al generar los códigos de Huffman para: %s\n", inputFileName);
+    }
+    return ok;
+}
+
+// Tabla que dejó la trama anterior del modo de flujo (solo los miembros canónicos dejan una)
+struct frameTable {
+    bool valid;
+    unsigned char lengths[256];
+    struct huffCode codes[256];
+};
+
+/**
+ * @brief Comprime una trama de HUFF_MODE_STREAM. Con el histograma de la trama se
+ * compara lo que ocuparía con la tabla de la trama anterior contra una tabla nueva
+ * (longitudes + datos); si reusar no cuesta más se escribe un miembro HUFF_MODE_REUSE,
+ * sin árbol ni longitudes. Si no, va un miembro normal y, si es canónico, su tabla
+ * pasa a ser la anterior (el decodificador la toma del mismo encabezado).
+ * @param out Recibe el miembro (liberar con free).
+ */
+static bool encodeStreamFrame(const unsigned char* data, size_t size, struct frameTable* previous,
+                              unsigned char** out, size_t* outSize) {
+    // Con LZ77, orden 1, la transformada o un diccionario, encodeMember puede ganarle a orden 0
+    bool plain = lzLevel == 0 && !contextModeling && !blockTransform && !dictionary.loaded;
+    if (plain && previous->valid) {
+        unsigned long long frequencies[256] = { 0 };
+        unsigned char lengths[256];
+        countFrequenciesParallel(data, size, frequencies);
+        bool covered = codeLengthsFromFrequencies(frequencies, lengths);
+        unsigned long long reuseBits = 0, freshBits = 0;
+        for (int i = 0; i < 256 && covered; i++) {
+            covered = frequencies[i] == 0 || previous->lengths[i] != 0;
+            reuseBits += frequencies[i] * previous->lengths[i];
+            freshBits += frequencies[i] * lengths[i];
+        }
+        if (covered && (reuseBits + 7) / 8 <= codeLengthsSize(lengths) + (freshBits + 7) / 8) {
+            char* buffer = NULL;
+            size_t bufferSize = 0;
+            FILE* memory = open_memstream(&buffer, &bufferSize);
+            struct bitWriter* writer = (struct bitWriter*)malloc(sizeof(struct bitWriter));
+            bool ok = memory != NULL && writer != NULL;
+            if (ok) {
+                long long total_chars = (long long)size;
+                fwrite(HUFF_MAGIC, 1, HUFF_MAGIC_SIZE, memory);
+                fputc(HUFF_MODE_REUSE, memory);
+                fwrite(&total_chars, sizeof(long long), 1, memory);
+                initBitWriter(writer, memory);
+                for (size_t i = 0; i < size; i++) {
+                    putCode(writer, previous->codes[data[i]]);
+                }
+                finishBitWriter(writer);
+            }
+            if (memory != NULL) fclose(memory);
+            free(writer);
+            if (!ok) {
+                free(buffer);
+                perror("Fallo de memoria para la trama");
+                return false;
+            }
+            *out = (unsigned char*)buffer;
+            *outSize = bufferSize;
+            return true;
+        }
+    }
+
+    if (!encodeMemberToMemory(data, size, out, outSize)) {
+        return false;
+    }
+    size_t position = HUFF_MAGIC_SIZE + 1 + sizeof(long long);
+    previous->valid = plain && *outSize > HUFF_MAGIC_SIZE && (*out)[HUFF_MAGIC_SIZE] == HUFF_MODE_CANONICAL &&
+                      parseCodeLengths(*out, *outSize, &position, previous->lengths) &&
+                      assignCanonicalCodes(previous->lengths, previous->codes);
+    return true;
+}
+
+/**
+ * @brief Comprime de un flujo a otro por tramas de HUFF_BLOCK_SIZE, cada una con
+ * su propia tabla o la de la anterior (HUFF_MODE_STREAM). No hace fseek ni guarda más de una trama
+ * en memoria, así que sirve para pipes (tar | huffman | ssh).
+ * @return true si la compresión fue exitosa.
+ */
+bool compressStreaming(FILE* inputFile, FILE* outputFile) {
+    long long total;
+    return compressStreamingCounted(inputFile, outputFile, &total);
+}
+
+/**
+ * @brief Como compressStreaming, y además devuelve en *total cuántos bytes se leyeron.
+ */
+bool compressStreamingCounted(FILE* inputFile, FILE* outputFile, long long* total) {
+    *total = 0;
+    unsigned char* block = (unsigned char*)malloc(HUFF_BLOCK_SIZE);
+    if (block == NULL) {
+        perror("Fallo de memoria para el buffer de entrada");
+        return false;
+    }
+    fwrite(HUFF_MAGIC, 1, HUFF_MAGIC_SIZE, outputFile);
+    fputc(HUFF_MODE_STREAM, outputFile);
+
+    struct frameTable previous = { .valid = false };
+    bool ok = true;
+    while (ok) {
+        // Llenar la trama completa (los pipes entregan de a pedazos)
+        size_t length = 0;
+        size_t bytesRead;
+        while (length < HUFF_BLOCK_SIZE &&
+               (bytesRead = fread(block + length, 1, HUFF_BLOCK_SIZE - length, inputFile)) > 0) {
+            length += bytesRead;
+        }
+        if (length == 0) break;
+        *total += (long long)length;
+
+        unsigned char* member;
+        size_t memberSize;
+        ok = encodeStreamFrame(block, length, &previous, &member, &memberSize);
+        if (ok) {
+            int frame[2] = { (int)length, (int)memberSize };
+            ok = fwrite(frame, sizeof(int), 2, outputFile) == 2 &&
+                 fwrite(member, 1, memberSize, outputFile) == memberSize;
+            free(member);
+        }
+    }
+    if (ferror(inputFile)) {
+        perror("Error al leer la entrada");
+        ok = false;
+    }
+
+    // Trama final (0, 0)
+    int end[2] = { 0, 0 };
+    fwrite(end, sizeof(int), 2, outputFile);
+    free(block);
+    return ok && fflush(outputFile) == 0;
+}
+
+// Modelo del modo adaptativo; el codificador y el decodificador lo actualizan igual
+struct adaptiveModel {
+    unsigned long long frequencies[256];
+    unsigned char lengths[256];
+    struct huffCode codes[256];
+};
+
+// El límite de longitud es fijo (no el de setCodeLengthLimit): el decodificador
+// tiene que recalcular exactamente los mismos códigos
+static bool rebuildAdaptiveCodes(struct adaptiveModel* model) {
+    return limitedCodeLengths(model->frequencies, HUFF_DEFAULT_CODE_LENGTH_LIMIT, model->lengths) &&
+           assignCanonicalCodes(model->lengths, model->codes);
+}
+
+static bool initAdaptiveModel(struct adaptiveModel* model) {
+    for (int i = 0; i < 256; i++) {
+        model->frequencies[i] = 1; // Todos los bytes tienen código desde el principio
+    }
+    return rebuildAdaptiveCodes(model);
+}
+
+// Suma los bytes de la trama y recalcula los códigos para la siguiente
+static bool updateAdaptiveModel(struct adaptiveModel* model, const unsigned char* data, size_t size) {
+    countFrequencies(data, size, model->frequencies);
+    scaleFrequencies(model->frequencies, HUFF_ADAPTIVE_FREQUENCY_LIMIT);
+    return rebuildAdaptiveCodes(model);
+}
+
+/**
+ * @brief Cuántos bytes de la trama se codifican con el modelo actual: hasta el
+ * próximo punto de calentamiento (HUFF_ADAPTIVE_WARMUP, el doble, ... mientras
+ * sea menor que HUFF_ADAPTIVE_INTERVAL) o hasta el final de la trama.
+ * @param seen Bytes del flujo antes de este tramo.
+ */
+static size_t adaptiveSegment(long long seen, size_t remaining) {
+    for (long long point = HUFF_ADAPTIVE_WARMUP; point < HUFF_ADAPTIVE_INTERVAL; point *= 2) {
+        if (point > seen) {
+            return ((long long)remaining < point - seen) ? remaining : (size_t)(point - seen);
+        }
+    }
+    return remaining;
+}
+
+/**
+ * @brief Comprime en un solo paso con Huffman adaptativo (HUFF_MODE_ADAPTIVE):
+ * cada trama se codifica con los códigos de todo lo anterior, así que no hace
+ * falta contar antes ni guardar tablas. La entrada se lee con read(), que
+ * devuelve lo que haya disponible, y cada trama se vacía apenas se codifica:
+ * una línea de log sale comprimida sin esperar a que se llene la trama.
+ * @return true si la compresión fue exitosa.
+ */
+bool compressAdaptive(FILE* inputFile, FILE* outputFile) {
+    struct adaptiveModel model;
+    unsigned char* frame = (unsigned char*)malloc(HUFF_ADAPTIVE_INTERVAL);
+    struct bitWriter* writer = (struct bitWriter*)malloc(sizeof(struct bitWriter));
+    if (frame == NULL || writer == NULL || !initAdaptiveModel(&model)) {
+        perror("Fallo de memoria para el modo adaptativo");
+        free(frame);
+        free(writer);
+        return false;
+    }
+    fwrite(HUFF_MAGIC, 1, HUFF_MAGIC_SIZE, outputFile);
+    fputc(HUFF_MODE_ADAPTIVE, outputFile);
+
+    bool ok = true;
+    long long seen = 0; // Bytes del flujo ya codificados
+    int inputFd = fileno(inputFile);
+    while (ok) {
+        ssize_t length = read(inputFd, frame, HUFF_ADAPTIVE_INTERVAL);
+        if (length < 0 && errno == EINTR) continue;
+        if (length < 0) {
+            perror("Error al leer la entrada");
+            ok = false;
+            break;
+        }
+        if (length == 0) break;
+
+        // El tamaño de los datos se conoce antes de codificar: con una copia del
+        // modelo se repiten los recálculos de calentamiento que caen en la trama
+        struct adaptiveModel preview = model;
+        unsigned long long bits = 0;
+        for (size_t position = 0; ok && position < (size_t)length; ) {
+            size_t segment = adaptiveSegment(seen + position, length - position);
+            for (size_t i = position; i < position + segment; i++) {
+                bits += preview.lengths[frame[i]];
+            }
+            position += segment;
+            if (position < (size_t)length) {
+                ok = updateAdaptiveModel(&preview, frame + position - segment, segment);
+            }
+        }
+        int header[2] = { (int)length, (int)((bits + 7) / 8) };
+        fwrite(header, sizeof(int), 2, outputFile);
+
+        // Después de cada tramo (el último también) el modelo suma lo visto
+        initBitWriter(writer, outputFile);
+        for (size_t position = 0; ok && position < (size_t)length; ) {
+            size_t segment = adaptiveSegment(seen + position, length - position);
+            for (size_t i = position; i < position + segment; i++) {
+                putCode(writer, model.codes[frame[i]]);
+            }
+            ok = updateAdaptiveModel(&model, frame + position, segment);
+            position += segment;
+        }
+        finishBitWriter(writer);
+        seen += length;
+        ok = ok && fflush(outputFile) == 0;
+    }
+
+    int end = 0;
+    fwrite(&end, sizeof(int), 1, outputFile);
+    free(frame);
+    free(writer);
+    return ok && fflush(outputFile) == 0;
+}
+
+/**
+ * @brief los parametros y el proposito de este procedimiento se explican solos.
+ * La entrada se lee una sola vez (mmap). Con "-" como entrada se comprime desde
+ * stdin en modo de flujo (igual que cualquier pipe, ver compressUnmappedInput), y
+ * con "-" como salida se escribe a stdout.
+ */
+void compressFile(const char *inputFileName, const char* outputFileName) {
+    bool toStdout = strcmp(outputFileName, "-") == 0;
+    FILE *outputFile = toStdout ? stdout : fopen(outputFileName, "wb");
+    if (outputFile == NULL) {
+        perror("Error al crear archivo de salida");
+        return;
+    }
+    if (strcmp(inputFileName, "-") == 0 || toStdout) {
+        // Ni stdin ni stdout permiten volver atrás: tramas independientes
+        FILE* inputFile = (strcmp(inputFileName, "-") == 0) ? stdin : fopen(inputFileName, "rb");
+        if (inputFile == NULL) {
+            perror("Error al abrir archivo de entrada");
+        } else {
+            compressStreaming(inputFile, outputFile);
+            if (inputFile != stdin) fclose(inputFile);
+        }
+    } else {
+        compressFileToStream(inputFileName, outputFile, NULL);
+    }
+
+    //End, yay
+    if (!toStdout) fclose(outputFile);
+}
+
+/**
+ * @brief Versión "segura para hilos" de compressFile. compressFile ya no usa
+ * variables globales, así que esto solo la llama (antes leía el archivo tres veces
+ * y generaba los códigos como strings).
+ */
+void compressFileParalel(const char *inputFileName, const char* outputFileName)
+{
+    compressFile(inputFileName, outputFileName);
+}
+
+
+/**
+ * @brief Obtiene el número total de caracteres que habían en el archivo comprimido
+ * @param fileName El nombre del archivo comprimido.
+ * @return El número total de caracteres, o -1 si hay un error.
+ */
+long long obtenerCantidadDeCaracteres(const char* fileName) {
+    FILE* file = fopen(fileName, "rb");
+    if (file == NULL) {
+        perror("Error al abrir el archivo");
+        return -1; // Devuelve un valor de error
+    }
+
+    long long total_chars = 0;
+    readHeaderMode(file); // Salta la marca si el archivo la tiene
+    // Lee 1 elemento del tamaño de un long long
+    if (fread(&total_chars, sizeof(long long), 1, file) != 1) {
+        fprintf(stderr, "Error al leer el conteo de caracteres del encabezado.\n");
+        fclose(file);
+        return -1; // Devuelve un valor de error
+    }
+
+    fclose(file);
+    return total_chars;
+}
+
+
+/**
+ * @brief Obtiene la tabla de frecuencias del encabezado del archivo.
+ * @param fileName El nombre del archivo comprimido.
+ * @param frequencies Un puntero a un array de 256 'unsigned long long' donde se guardarán las frecuencias.
+ * @return 'true' si la operación fue exitosa, 'false' si hubo un error.
+ */
+bool obtenerTablaDeFrecuencias(const char* fileName, unsigned long long* frequencies) {
+    FILE* file = fopen(fileName, "rb");
+    if (file == NULL) {
+        perror("Error al abrir el archivo");
+        return false;
+    }
+
+    // Los archivos con códigos canónicos no guardan frecuencias
+    if (readHeaderMode(file) != 0) {
+        fprintf(stderr, "El archivo usa códigos canónicos y no tiene tabla de frecuencias.\n");
+        fclose(file);
+        return false;
+    }
+
+    // SALTA los primeros bytes que corresponden al conteo de caracteres
+    // fseek(archivo, desplazamiento, desde_donde);
+    // SEEK_SET significa "desde el inicio del archivo".
+    if (fseek(file, sizeof(long long), SEEK_SET) != 0) {
+        fprintf(stderr, "Error al buscar la posición de la tabla de frecuencias.\n");
+        fclose(file);
+        return false;
+    }
+
+    // Lee los 256 elementos de la tabla de frecuencias
+    if (fread(frequencies, sizeof(unsigned long long), 256, file) != 256) {
+        fprintf(stderr, "Error al leer la tabla de frecuencias del encabezado.\n");
+        fclose(file);
+        return false;
+    }
+
+    fclose(file);
+    return true; // Éxito
+}
+
+/**
+ * @brief Arma los códigos (como strings) a partir de la tabla de frecuencias del
+ * formato viejo, con el mismo árbol que usaba el compresor original.
+ */
+static char** codigosDesdeFrecuencias(const unsigned long long* frequencies) {
+    int size = 0;//Cantidad total de elementos mayores a 0
+    for (int i = 0; i < 256; i++) {
+        if (frequencies[i] > 0) {
+            size++;
+        }
+    }
+
+    // Asignamos memoria para ese número exacto de caracteres.
+    struct letter* letters = (struct letter*)malloc(size * sizeof(struct letter));
+    if (letters == NULL) {
+        perror("Fallo al asignar memoria para la lista de letras");
+        return NULL;
+    }
+
+    // Llenamos la lista con los caracteres y sus frecuencias.
+    int currentIndex = 0;
+    for (int i = 0; i < 256; i++) {
+        if (frequencies[i] > 0) {
+            letters[currentIndex].letter = (unsigned char)i;
+            letters[currentIndex].frequency = frequencies[i];
+            currentIndex++;
+        }
+    }
+
+    // --- Pasos finales: Reconstruir el árbol de Huffman a partir de las frecuencias ---
     struct treeNode* huffmanRoot = buildHuffmanTree(letters, size);
     char** huffman_codes = (char**)calloc(256, sizeof(char*));
 
-    if (huffman_codes == NULL) {
-        perror("Fallo al asignar memoria para la tabla de códigos");
-        // Limpieza antes de salir
-        free(letters);
-        freeTree(huffmanRoot);
+    if (huffman_codes == NULL) {
+        perror("Fallo al asignar memoria para la tabla de códigos");
+        // Limpieza antes de salir
+        free(letters);
+        freeTree(huffmanRoot);
+        return NULL;
+    }
+    char path[256] = {0};
+    generateCodes(huffmanRoot, path, 0, huffman_codes);
+
+    // --- Limpiar ---
+    free(letters);      
+    freeTree(huffmanRoot); // Usar esta función para borrar el arbol!
+
+
+    return huffman_codes;
+}
+
+/**
+ * @brief Esta cosa obtiene los codigos desde un archivo.
+ * @param compressedFileName es el archivo comprimido
+ * @returns char** huffmanCodes, añlocados y todo.
+ */
+char** reconstruirCodigos(const char* compressedFileName) {
+    // Formato canónico: los códigos salen directo de las longitudes
+    FILE* file = fopen(compressedFileName, "rb");
+    if (file == NULL) {
+        perror("Error al abrir el archivo");
+        return NULL;
+    }
+    if (readHeaderMode(file) == HUFF_MODE_CANONICAL) {
+        unsigned char lengths[256];
+        struct huffCode codes[256];
+        bool ok = fseek(file, sizeof(long long), SEEK_CUR) == 0 &&
+                  readCodeLengths(file, lengths) && assignCanonicalCodes(lengths, codes);
+        fclose(file);
+        return ok ? codesToStrings(codes) : NULL;
+    }
+    fclose(file);
+
+    unsigned long long frequencies[256];
+    if (!obtenerTablaDeFrecuencias(compressedFileName, frequencies)) {
+        fprintf(stderr, "Error: No se pudo obtener la tabla de frecuencias. Abortando.\n");
+        return NULL; // Devuelve NULL para indicar un fallo.
+    }
+    return codigosDesdeFrecuencias(frequencies);
+}
+
+/** 
+ * @brief para limpiar la memoria de la tabla de codigos, importante cuando tenga que paralelizarse todo después.
+*/
+void liberarCodigos(char** codes){
+    if (codes == NULL) { return; }
+
+    for (int i = 0; i < 256; i++) {
+        if (codes[i] != NULL) {
+            free(codes[i]); // Libera la memoria del string
+        }
+    }
+    free(codes);
+}
+
+//--------------------------------------------------------------------------//
+//                                                                          //
+//              Lector de bits y decodificación por tablas                  //
+//                                                                          //
+//--------------------------------------------------------------------------//
+
+#define DECODE_BUFFER_SIZE (1 << 16)
+
+// Lector de bits con acumulador de 64 bits. Lee de un archivo en bloques
+// de 64 KB, o directamente de un rango de memoria si file es NULL.
+struct bitReader {
+    FILE* file;
+    const unsigned char* data;
+    size_t length;
+    size_t position;
+    unsigned char* fileBuffer;      // Solo para archivos
+    unsigned long long accumulator; // Bits pendientes, alineados a la derecha
+    int count;                      // Cuántos bits válidos hay en el acumulador
+    int padding;                    // Bytes en cero agregados después del final
+};
+
+static void initBitReaderMemory(struct bitReader* reader, const unsigned char* data, size_t length) {
+    reader->file = NULL;
+    reader->data = data;
+    reader->length = length;
+    reader->position = 0;
+    reader->fileBuffer = NULL;
+    reader->accumulator = 0;
+    reader->count = 0;
+    reader->padding = 0;
+}
+
+static bool initBitReaderFile(struct bitReader* reader, FILE* file) {
+    initBitReaderMemory(reader, NULL, 0);
+    reader->file = file;
+    reader->fileBuffer = (unsigned char*)malloc(DECODE_BUFFER_SIZE);
+    return reader->fileBuffer != NULL;
+}
+
+static void closeBitReader(struct bitReader* reader) {
+    free(reader->fileBuffer);
+    reader->fileBuffer = NULL;
+}
+
+// Deja al menos 57 bits en el acumulador (con ceros si se acabó la entrada)
+static inline void refillBits(struct bitReader* reader) {
+    while (reader->count <= 56) {
+        if (reader->position == reader->length) {
+            if (reader->file != NULL) {
+                reader->length = fread(reader->fileBuffer, 1, DECODE_BUFFER_SIZE, reader->file);
+                reader->data = reader->fileBuffer;
+                reader->position = 0;
+            }
+            if (reader->position == reader->length) {
+                reader->accumulator <<= 8;
+                reader->count += 8;
+                reader->padding++;
+                continue;
+            }
+        }
+        reader->accumulator = (reader->accumulator << 8) | reader->data[reader->position++];
+        reader->count += 8;
+    }
+}
+
+static inline unsigned int peekBits(const struct bitReader* reader, int bits) {
+    return (unsigned int)((reader->accumulator >> (reader->count - bits)) & ((1ULL << bits) - 1));
+}
+
+/**
+ * @brief Decodifica 'total' símbolos del lector usando la tabla y los deja en 'out'.
+ * @return false si el flujo es inválido o se cortó antes de tiempo.
+ */
+static bool decodeSymbolsInto(struct bitReader* reader, const struct decodeTable* table,
+                              size_t total, unsigned char* out) {
+    const struct decodeEntry* entries = table->entries;
+    size_t decoded = 0;
+
+    while (decoded < total) {
+        refillBits(reader);
+        // Más de 8 bytes inventados significa que el flujo se cortó
+        if (reader->padding > 8) return false;
+
+        int tableBits = HUFF_TABLE_BITS;
+        struct decodeEntry entry = entries[peekBits(reader, tableBits)];
+        while (entry.type == DECODE_LINK) {
+            reader->count -= tableBits;
+            if (reader->count < HUFF_TABLE_BITS) refillBits(reader);
+            tableBits = entry.bits;
+            entry = entries[entry.value + peekBits(reader, tableBits)];
+        }
+        if (entry.type != DECODE_LEAF) return false;
+
+        reader->count -= entry.bits;
+        out[decoded++] = (unsigned char)entry.value;
+    }
+    return true;
+}
+
+/**
+ * @brief Igual que decodeSymbolsInto, pero la tabla de cada símbolo depende del
+ * byte anterior (HUFF_MODE_CONTEXT).
+ * @param previous Byte anterior al primero; al terminar queda el último decodificado.
+ */
+static bool decodeContextSymbolsInto(struct bitReader* reader, const struct contextModel* model,
+                                     unsigned char* previous, size_t total, unsigned char* out) {
+    unsigned char last = *previous;
+    size_t decoded = 0;
+
+    while (decoded < total) {
+        refillBits(reader);
+        if (reader->padding > 8) return false;
+
+        const struct decodeEntry* entries = model->tables[model->classOf[last]]->entries;
+        int tableBits = HUFF_TABLE_BITS;
+        struct decodeEntry entry = entries[peekBits(reader, tableBits)];
+        while (entry.type == DECODE_LINK) {
+            reader->count -= tableBits;
+            if (reader->count < HUFF_TABLE_BITS) refillBits(reader);
+            tableBits = entry.bits;
+            entry = entries[entry.value + peekBits(reader, tableBits)];
+        }
+        if (entry.type != DECODE_LEAF) return false;
+
+        reader->count -= entry.bits;
+        last = (unsigned char)entry.value;
+        out[decoded++] = last;
+    }
+    *previous = last;
+    return true;
+}
+
+// Lee un valor de LZ77: su código con la tabla y después los bits extra
+static inline bool readLzValue(struct bitReader* reader, const struct decodeTable* table, unsigned int* value) {
+    unsigned char code;
+    unsigned int base;
+    int extraBits;
+    if (!decodeSymbolsInto(reader, table, 1, &code) || !lzValueBase(code, &base, &extraBits)) {
+        return false;
+    }
+    if (extraBits > 0) {
+        refillBits(reader);
+        base += peekBits(reader, extraBits);
+        reader->count -= extraBits;
+    }
+    *value = base;
+    return true;
+}
+
+/**
+ * @brief Decodifica un miembro HUFF_MODE_LZ completo: las copias apuntan hacia
+ * atrás en out, así que hay que decodificar todo el miembro de una vez.
+ * @return false si el flujo es inválido (incluye distancias fuera de lo ya decodificado).
+ */
+static bool decodeLzInto(struct bitReader* reader, const struct huffDecoder* decoder,
+                         size_t total, unsigned char* out) {
+    size_t written = 0;
+    while (written < total) {
+        unsigned int literals, length, distance;
+        if (!readLzValue(reader, decoder->lzTables[0], &literals) || literals > total - written ||
+            !decodeSymbolsInto(reader, decoder->table, literals, out + written)) {
+            return false;
+        }
+        written += literals;
+        if (written == total) break;
+
+        if (!readLzValue(reader, decoder->lzTables[1], &length) ||
+            !readLzValue(reader, decoder->lzTables[2], &distance)) {
+            return false;
+        }
+        length += HUFF_LZ_MIN_MATCH;
+        distance += 1;
+        if (distance > written || length > total - written || reader->padding > 8) {
+            return false;
+        }
+        // Byte por byte: la copia puede pisarse a sí misma (distancia < largo)
+        const unsigned char* from = out + written - distance;
+        for (unsigned int k = 0; k < length; k++) {
+            out[written + k] = from[k];
+        }
+        written += length;
+    }
+    return true;
+}
+
+// Decodifica con la tabla única, las de contexto o las de LZ77, según el miembro
+static bool decodeWithDecoder(struct huffDecoder* decoder, struct bitReader* reader,
+                              size_t total, unsigned char* out) {
+    if (decoder->mode == HUFF_MODE_LZ) {
+        return decodeLzInto(reader, decoder, total, out);
+    }
+    if (decoder->context != NULL) {
+        return decodeContextSymbolsInto(reader, decoder->context, &decoder->previous, total, out);
+    }
+    return decodeSymbolsInto(reader, decoder->table, total, out);
+}
+
+/**
+ * @brief Decodifica todos los símbolos del miembro y los escribe en bloques
+ * al archivo de salida.
+ * @return La cantidad de símbolos decodificados, o -1 si el flujo es inválido.
+ */
+static long long decodeSymbols(struct bitReader* reader, struct huffDecoder* decoder, FILE* outputFile) {
+    long long total = decoder->total;
+    unsigned char* out = (unsigned char*)malloc(DECODE_BUFFER_SIZE);
+    if (out == NULL) {
+        perror("Fallo de memoria para el buffer de salida");
+        return -1;
+    }
+
+    long long decoded = 0;
+    while (decoded < total) {
+        size_t chunk = (total - decoded < DECODE_BUFFER_SIZE) ? (size_t)(total - decoded) : DECODE_BUFFER_SIZE;
+        if (!decodeWithDecoder(decoder, reader, chunk, out)) break;
+        fwrite(out, 1, chunk, outputFile);
+        decoded += chunk;
+    }
+
+    free(out);
+    return (decoded == total) ? decoded : -1;
+}
+
+//--------------------------------------------------------------------------//
+//                                                                          //
+//                Modelo de contexto (orden 1): decodificación              //
+//                                                                          //
+//--------------------------------------------------------------------------//
+
+static void freeContextModel(struct contextModel* model) {
+    if (model == NULL) return;
+    for (int k = 0; k < model->classCount; k++) {
+        freeDecodeTable(model->tables[k]);
+    }
+    free(model);
+}
+
+static struct contextModel* newContextModel(int classCount) {
+    if (classCount < 1 || classCount > 256) {
+        return NULL;
+    }
+    struct contextModel* model = (struct contextModel*)calloc(1, sizeof(struct contextModel));
+    if (model != NULL) {
+        model->classCount = classCount;
+    }
+    return model;
+}
+
+// Arma la tabla de la clase k; con la última clase verifica el mapa de contextos
+static bool addContextClass(struct contextModel* model, int k, const unsigned char* lengths) {
+    struct huffCode codes[256];
+    if (!assignCanonicalCodes(lengths, codes) || (model->tables[k] = buildDecodeTable(codes)) == NULL) {
+        return false;
+    }
+    if (k == model->classCount - 1) {
+        for (int c = 0; c < 256; c++) {
+            if (model->classOf[c] >= model->classCount) return false;
+        }
+    }
+    return true;
+}
+
+// Lee [int clases][mapa de clases][longitudes de cada clase] desde un archivo
+static struct contextModel* readContextModel(FILE* input) {
+    int classCount;
+    if (fread(&classCount, sizeof(int), 1, input) != 1) {
+        return NULL;
+    }
+    struct contextModel* model = newContextModel(classCount);
+    bool ok = model != NULL && readCodeLengths(input, model->classOf);
+    for (int k = 0; ok && k < classCount; k++) {
+        unsigned char lengths[256];
+        ok = readCodeLengths(input, lengths) && addContextClass(model, k, lengths);
+    }
+    if (!ok) {
+        freeContextModel(model);
+        return NULL;
+    }
+    return model;
+}
+
+// Igual que readContextModel, pero desde memoria
+static struct contextModel* parseContextModel(const unsigned char* data, size_t size, size_t* position) {
+    int classCount;
+    if (size - *position < sizeof(int)) {
+        return NULL;
+    }
+    memcpy(&classCount, data + *position, sizeof(int));
+    *position += sizeof(int);
+    struct contextModel* model = newContextModel(classCount);
+    bool ok = model != NULL && parseCodeLengths(data, size, position, model->classOf);
+    for (int k = 0; ok && k < classCount; k++) {
+        unsigned char lengths[256];
+        ok = parseCodeLengths(data, size, position, lengths) && addContextClass(model, k, lengths);
+    }
+    if (!ok) {
+        freeContextModel(model);
+        return NULL;
+    }
+    return model;
+}
+
+/**
+ * @brief Deshace un miembro transformado: Huffman, rachas de ceros, MTF y BWT.
+ * @param data Lo que sigue al campo "bytes que siguen" de HUFF_MODE_TRANSFORM.
+ * @param out Recibe un buffer nuevo (malloc) con los datos originales.
+ * @param total Recibe la cantidad de caracteres originales.
+ * @return false si el miembro está dañado o falta memoria.
+ */
+static bool decodeTransformedMember(const unsigned char* data, size_t size, unsigned char** out, long long* total) {
+    size_t position = 0;
+    int blockCount;
+    long long transformed;
+    *out = NULL;
+    if (size < sizeof(long long) + sizeof(int)) {
+        return false;
+    }
+    memcpy(total, data, sizeof(long long));
+    memcpy(&blockCount, data + sizeof(long long), sizeof(int));
+    position = sizeof(long long) + sizeof(int);
+    if (*total < 0 || blockCount < 0 || blockCount != transformBlockCount(*total) ||
+        size - position < blockCount * sizeof(int) + sizeof(long long)) {
+        return false;
+    }
+    int* primary = (int*)malloc((blockCount > 0 ? blockCount : 1) * sizeof(int));
+    if (primary == NULL) {
+        return false;
+    }
+    memcpy(primary, data + position, blockCount * sizeof(int));
+    position += blockCount * sizeof(int);
+    memcpy(&transformed, data + position, sizeof(long long));
+    position += sizeof(long long);
+
+    unsigned char* runs = (transformed >= 0) ? (unsigned char*)malloc(transformed > 0 ? transformed : 1) : NULL;
+    unsigned char* sorted = (unsigned char*)malloc(*total > 0 ? *total : 1);
+    unsigned char* result = (unsigned char*)malloc(*total > 0 ? *total : 1);
+    bool ok = runs != NULL && sorted != NULL && result != NULL &&
+              decodeMemberFromMemory(data + position, size - position, runs, transformed) &&
+              zeroRunDecode(runs, transformed, sorted, *total);
+    if (ok) {
+        mtfDecode(sorted, *total);
+        ok = bwtInverseBlocks(sorted, *total, primary, result);
+    }
+
+    free(primary);
+    free(runs);
+    free(sorted);
+    if (!ok) {
+        free(result);
+        return false;
+    }
+    *out = result;
+    return true;
+}
+
+/**
+ * @brief Descomprime un miembro canónico o de contexto completo (encabezado + datos) que está en memoria.
+ * @param data Bytes del miembro comprimido.
+ * @param size Tamaño del miembro comprimido.
+ * @param out Buffer de salida, de al menos expectedSize bytes.
+ * @param expectedSize Cantidad de caracteres que debe contener el miembro.
+ * @return true si se decodificó completo.
+ */
+bool decodeMemberFromMemory(const unsigned char* data, size_t size, unsigned char* out, size_t expectedSize) {
+    if (size < HUFF_MAGIC_SIZE + 1 || memcmp(data, HUFF_MAGIC, HUFF_MAGIC_SIZE) != 0) {
+        return false;
+    }
+    if (data[HUFF_MAGIC_SIZE] == HUFF_MODE_TRANSFORM) {
+        size_t position = HUFF_MAGIC_SIZE + 1 + sizeof(long long);
+        unsigned char* result;
+        long long total;
+        if (size < position || !decodeTransformedMember(data + position, size - position, &result, &total)) {
+            return false;
+        }
+        bool ok = total == (long long)expectedSize;
+        if (ok) memcpy(out, result, expectedSize);
+        free(result);
+        return ok;
+    }
+    if (data[HUFF_MAGIC_SIZE] == HUFF_MODE_STORED) {
+        size_t position = HUFF_MAGIC_SIZE + 1 + sizeof(long long);
+        long long total;
+        if (size < position || size - position != expectedSize) {
+            return false;
+        }
+        memcpy(&total, data + HUFF_MAGIC_SIZE + 1, sizeof(long long));
+        if (total != (long long)expectedSize) {
+            return false;
+        }
+        memcpy(out, data + position, expectedSize);
+        return true;
+    }
+    if (data[HUFF_MAGIC_SIZE] != HUFF_MODE_CANONICAL && data[HUFF_MAGIC_SIZE] != HUFF_MODE_CONTEXT &&
+        data[HUFF_MAGIC_SIZE] != HUFF_MODE_LZ && data[HUFF_MAGIC_SIZE] != HUFF_MODE_DICTIONARY) {
+        return false;
+    }
+
+    struct huffDecoder decoder;
+    bool ok = openDecoderMemory(&decoder, data, size) && decoder.total == (long long)expectedSize;
+    if (ok && expectedSize > 0) {
+        struct bitReader reader;
+        initBitReaderMemory(&reader, decoder.data, decoder.size);
+        ok = decodeWithDecoder(&decoder, &reader, expectedSize, out);
+    }
+    closeDecoder(&decoder);
+    return ok;
+}
+
+/**
+ * @brief Decodifica 'count' símbolos de un tramo en memoria que empieza
+ * 'skipBits' bits después de data (para los puntos de sincronización).
+ * @return true si se decodificó completo.
+ */
+bool decodeSymbolsFromMemory(const struct decodeTable* table, const unsigned char* data, size_t size,
+                             int skipBits, unsigned char* out, size_t count) {
+    struct bitReader reader;
+    initBitReaderMemory(&reader, data, size);
+    refillBits(&reader);
+    reader.count -= skipBits;
+    return decodeSymbolsInto(&reader, table, count, out);
+}
+
+/**
+ * @brief Descomprime un miembro con puntos de sincronización (HUFF_MODE_INDEXED):
+ * lee el índice que está después de los datos y reparte los tramos entre hilos.
+ * @param compressedFile Posicionado justo después del byte de modo.
+ * @return La cantidad de caracteres descomprimidos, o -1 si hubo un error.
+ */
+static long long decompressIndexedMember(FILE* compressedFile, FILE* outputFile) {
+    long long total_chars;
+    unsigned char lengths[256];
+    int interval;
+    long long dataBytes;
+    if (fread(&total_chars, sizeof(long long), 1, compressedFile) != 1 || total_chars < 0 ||
+        !readCodeLengths(compressedFile, lengths) ||
+        fread(&interval, sizeof(int), 1, compressedFile) != 1 || interval <= 0 ||
+        fread(&dataBytes, sizeof(long long), 1, compressedFile) != 1 || dataBytes < 0) {
+        fprintf(stderr, "Error: encabezado inválido\n");
+        return -1;
+    }
+
+    // El índice está justo después de los datos
+    long long dataOffset = ftell(compressedFile);
+    int pointCount;
+    if (fseek(compressedFile, dataOffset + dataBytes, SEEK_SET) != 0 ||
+        fread(&pointCount, sizeof(int), 1, compressedFile) != 1 ||
+        (long long)pointCount != (total_chars + interval - 1) / interval) {
+        fprintf(stderr, "Error: índice de sincronización inválido\n");
+        return -1;
+    }
+    long long* bitOffsets = (long long*)malloc((pointCount > 0 ? pointCount : 1) * sizeof(long long));
+    if (bitOffsets == NULL ||
+        fread(bitOffsets, sizeof(long long), pointCount, compressedFile) != (size_t)pointCount) {
+        fprintf(stderr, "Error al leer el índice de sincronización\n");
+        free(bitOffsets);
+        return -1;
+    }
+    for (int k = 0; k < pointCount; k++) {
+        long long next = (k + 1 < pointCount) ? bitOffsets[k + 1] : dataBytes * 8;
+        if (bitOffsets[k] < 0 || bitOffsets[k] > next) {
+            fprintf(stderr, "Error: índice de sincronización inválido\n");
+            free(bitOffsets);
+            return -1;
+        }
+    }
+    if (total_chars == 0) { // Archivo original vacío
+        free(bitOffsets);
+        return 0;
+    }
+
+    struct huffCode codes[256];
+    struct decodeTable* table = assignCanonicalCodes(lengths, codes) ? buildDecodeTable(codes) : NULL;
+    bool ok = table != NULL &&
+              decompressSyncPoints(fileno(compressedFile), dataOffset, dataBytes, table, total_chars,
+                                   interval, bitOffsets, pointCount, outputFile);
+    freeDecodeTable(table);
+    free(bitOffsets);
+    return ok ? total_chars : -1;
+}
+
+/**
+ * @brief Tabla que una trama de HUFF_MODE_STREAM deja para las siguientes: la de
+ * su encabezado si es un miembro canónico, ninguna (NULL) si no.
+ */
+static struct decodeTable* frameDecodeTable(const unsigned char* member, size_t size) {
+    size_t position = HUFF_MAGIC_SIZE + 1 + sizeof(long long);
+    unsigned char lengths[256];
+    struct huffCode codes[256];
+    if (size <= HUFF_MAGIC_SIZE || memcmp(member, HUFF_MAGIC, HUFF_MAGIC_SIZE) != 0 ||
+        member[HUFF_MAGIC_SIZE] != HUFF_MODE_CANONICAL || !parseCodeLengths(member, size, &position, lengths) ||
+        !assignCanonicalCodes(lengths, codes)) {
+        return NULL;
+    }
+    return buildDecodeTable(codes);
+}
+
+// Decodifica una trama HUFF_MODE_REUSE con la tabla de la trama anterior
+static bool decodeReusedFrame(const unsigned char* member, size_t size, const struct decodeTable* table,
+                              unsigned char* out, size_t expectedSize) {
+    size_t header = HUFF_MAGIC_SIZE + 1 + sizeof(long long);
+    long long total;
+    if (table == NULL || size < header) {
+        return false;
+    }
+    memcpy(&total, member + HUFF_MAGIC_SIZE + 1, sizeof(long long));
+    if (total != (long long)expectedSize) {
+        return false;
+    }
+    struct bitReader reader;
+    initBitReaderMemory(&reader, member + header, size - header);
+    return decodeSymbolsInto(&reader, table, expectedSize, out);
+}
+
+/**
+ * @brief Descomprime las tramas de HUFF_MODE_STREAM una por una, con memoria
+ * constante (una trama comprimida y una descomprimida).
+ * @param compressedFile Posicionado justo después del byte de modo; puede ser un pipe.
+ * @return La cantidad de caracteres descomprimidos, o -1 si hubo un error.
+ */
+static long long decompressStreamFrames(FILE* compressedFile, FILE* outputFile) {
+    unsigned char* out = (unsigned char*)malloc(HUFF_BLOCK_SIZE);
+    unsigned char* in = NULL;
+    size_t inCapacity = 0;
+    struct decodeTable* previous = NULL; // Tabla de la última trama canónica
+    long long decoded = 0;
+    if (out == NULL) {
+        perror("Fallo de memoria para el buffer de salida");
+        return -1;
+    }
+
+    while (true) {
+        int frame[2];
+        if (fread(frame, sizeof(int), 2, compressedFile) != 2 ||
+            frame[0] < 0 || frame[0] > HUFF_BLOCK_SIZE || frame[1] < 0) {
+            fprintf(stderr, "Error: trama inválida o flujo cortado\n");
+            decoded = -1;
+            break;
+        }
+        if (frame[0] == 0 && frame[1] == 0) break; // Fin del flujo
+
+        if ((size_t)frame[1] > inCapacity) {
+            unsigned char* grown = (unsigned char*)realloc(in, frame[1]);
+            if (grown == NULL) {
+                perror("Fallo de memoria para la trama");
+                decoded = -1;
+                break;
+            }
+            in = grown;
+            inCapacity = frame[1];
+        }
+        bool ok = fread(in, 1, frame[1], compressedFile) == (size_t)frame[1];
+        if (ok && frame[1] > HUFF_MAGIC_SIZE && memcmp(in, HUFF_MAGIC, HUFF_MAGIC_SIZE) == 0 &&
+            in[HUFF_MAGIC_SIZE] == HUFF_MODE_REUSE) {
+            ok = decodeReusedFrame(in, frame[1], previous, out, frame[0]);
+        } else if (ok) {
+            ok = decodeMemberFromMemory(in, frame[1], out, frame[0]);
+            freeDecodeTable(previous);
+            previous = frameDecodeTable(in, frame[1]);
+        }
+        if (!ok || fwrite(out, 1, frame[0], outputFile) != (size_t)frame[0]) {
+            fprintf(stderr, "Error: trama corrupta\n");
+            decoded = -1;
+            break;
+        }
+        decoded += frame[0];
+    }
+
+    freeDecodeTable(previous);
+    free(in);
+    free(out);
+    return decoded;
+}
+
+/**
+ * @brief Descomprime las tramas de HUFF_MODE_ADAPTIVE: decodifica cada una con
+ * el modelo actual y lo actualiza igual que el codificador.
+ * @param compressedFile Posicionado justo después del byte de modo; puede ser un pipe.
+ * @return La cantidad de caracteres descomprimidos, o -1 si hubo un error.
+ */
+static long long decompressAdaptiveFrames(FILE* compressedFile, FILE* outputFile) {
+    struct adaptiveModel model;
+    unsigned char* out = (unsigned char*)malloc(HUFF_ADAPTIVE_INTERVAL);
+    unsigned char* in = NULL;
+    size_t inCapacity = 0;
+    long long decoded = 0; // También dice dónde caen los recálculos de calentamiento
+    struct decodeTable* table = initAdaptiveModel(&model) ? buildDecodeTable(model.codes) : NULL;
+    if (out == NULL || table == NULL) {
+        perror("Fallo de memoria para el modo adaptativo");
+        free(out);
+        freeDecodeTable(table);
+        return -1;
+    }
+
+    while (true) {
+        int length;
+        if (fread(&length, sizeof(int), 1, compressedFile) != 1 ||
+            length < 0 || length > HUFF_ADAPTIVE_INTERVAL) {
+            fprintf(stderr, "Error: trama inválida o flujo cortado\n");
+            decoded = -1;
+            break;
+        }
+        if (length == 0) break; // Fin del flujo
+
+        int bytes;
+        if (fread(&bytes, sizeof(int), 1, compressedFile) != 1 || bytes < 0) {
+            fprintf(stderr, "Error: trama inválida o flujo cortado\n");
+            decoded = -1;
+            break;
+        }
+        if ((size_t)bytes > inCapacity) {
+            unsigned char* grown = (unsigned char*)realloc(in, bytes);
+            if (grown == NULL) {
+                perror("Fallo de memoria para la trama");
+                decoded = -1;
+                break;
+            }
+            in = grown;
+            inCapacity = bytes;
+        }
+
+        struct bitReader reader;
+        initBitReaderMemory(&reader, in, bytes);
+        bool ok = fread(in, 1, bytes, compressedFile) == (size_t)bytes;
+        for (size_t position = 0; ok && position < (size_t)length; ) {
+            size_t segment = adaptiveSegment(decoded + position, length - position);
+            ok = decodeSymbolsInto(&reader, table, segment, out + position);
+            freeDecodeTable(table);
+            table = (ok && updateAdaptiveModel(&model, out + position, segment)) ? buildDecodeTable(model.codes) : NULL;
+            ok = ok && table != NULL;
+            position += segment;
+        }
+        if (!ok || fwrite(out, 1, length, outputFile) != (size_t)length) {
+            fprintf(stderr, "Error: trama corrupta\n");
+            decoded = -1;
+            break;
+        }
+        fflush(outputFile);
+        decoded += length;
+    }
+
+    freeDecodeTable(table);
+    free(in);
+    free(out);
+    return decoded;
+}
+
+/**
+ * @brief Descomprime un miembro HUFF_MODE_TRANSFORM desde el archivo o la memoria
+ * del decodificador. El miembro transformado se deshace entero en memoria (a lo
+ * sumo HUFF_BLOCK_THRESHOLD bytes: los archivos más grandes van por bloques).
+ * @return La cantidad de caracteres descomprimidos, o -1 si hubo un error.
+ */
+static long long decompressTransformed(struct huffDecoder* decoder, FILE* outputFile) {
+    long long rest;
+    unsigned char* member = NULL;
+    const unsigned char* data;
+    if (decoder->file != NULL) {
+        if (fread(&rest, sizeof(long long), 1, decoder->file) != 1 || rest < 0 ||
+            (member = (unsigned char*)malloc(rest > 0 ? rest : 1)) == NULL ||
+            fread(member, 1, rest, decoder->file) != (size_t)rest) {
+            fprintf(stderr, "Error: miembro transformado incompleto\n");
+            free(member);
+            return -1;
+        }
+        data = member;
+    } else {
+        if (decoder->size < sizeof(long long)) {
+            fprintf(stderr, "Error: miembro transformado incompleto\n");
+            return -1;
+        }
+        memcpy(&rest, decoder->data, sizeof(long long));
+        if (rest < 0 || (unsigned long long)rest > decoder->size - sizeof(long long)) {
+            fprintf(stderr, "Error: miembro transformado incompleto\n");
+            return -1;
+        }
+        data = decoder->data + sizeof(long long);
+    }
+
+    unsigned char* result;
+    long long total;
+    bool ok = decodeTransformedMember(data, rest, &result, &total);
+    free(member);
+    if (!ok) {
+        fprintf(stderr, "Error: datos comprimidos corruptos o incompletos\n");
+        return -1;
+    }
+    ok = fwrite(result, 1, total, outputFile) == (size_t)total;
+    free(result);
+    return ok ? total : -1;
+}
+
+// Arma las cuatro tablas de HUFF_MODE_LZ: table para los literales y lzTables para el resto
+static bool prepareLzTables(struct huffDecoder* decoder, unsigned char lengths[HUFF_LZ_TABLES][256]) {
+    struct huffCode codes[256];
+    for (int t = 0; t < HUFF_LZ_TABLES; t++) {
+        struct decodeTable* table = NULL;
+        if (assignCanonicalCodes(lengths[t], codes)) {
+            table = buildDecodeTable(codes);
+        }
+        if (table == NULL) {
+            fprintf(stderr, "Error: No se pudo crear la tabla de decodificación\n");
+            return false;
+        }
+        if (t == 0) decoder->table = table;
+        else decoder->lzTables[t - 1] = table;
+    }
+    return true;
+}
+
+// HUFF_MODE_LZ: las copias miran hacia atrás, así que el miembro se decodifica entero
+static long long decompressLzMember(struct huffDecoder* decoder, FILE* outputFile) {
+    unsigned char* out = (unsigned char*)malloc(decoder->total);
+    if (out == NULL) {
+        perror("Fallo de memoria para el buffer de salida");
+        return -1;
+    }
+    struct bitReader reader;
+    bool ok;
+    if (decoder->file != NULL) {
+        ok = initBitReaderFile(&reader, decoder->file) && decodeLzInto(&reader, decoder, decoder->total, out);
+    } else {
+        initBitReaderMemory(&reader, decoder->data, decoder->size);
+        ok = decodeLzInto(&reader, decoder, decoder->total, out);
+    }
+    closeBitReader(&reader);
+    ok = ok && fwrite(out, 1, decoder->total, outputFile) == (size_t)decoder->total;
+    free(out);
+    return ok ? decoder->total : -1;
+}
+
+// Mensaje de fin; si la salida es stdout no se imprime nada para no mezclarlo con los datos
+static void reportDecoded(FILE* outputFile, long long decoded) {
+    if (outputFile != stdout) {
+        printf("Descompresión completada: %lld caracteres decodificados\n", decoded);
+    }
+}
+
+/**
+ * @brief Arma la tabla del decodificador con las longitudes (modo canónico)
+ * o con la tabla de frecuencias (formato viejo, lengths en NULL).
+ */
+static bool prepareDecoderTable(struct huffDecoder* decoder, const unsigned char* lengths,
+                                const unsigned long long* frequencies) {
+    struct huffCode codes[256];
+    if (decoder->total == 0) { // Archivo original vacío
+        return true;
+    }
+
+    if (lengths != NULL) {
+        // Formato canónico: la tabla sale directo de las longitudes, sin árbol
+        if (assignCanonicalCodes(lengths, codes)) {
+            decoder->table = buildDecodeTable(codes);
+        }
+    } else {
+        // Reconstruir los códigos de Huffman
+        char** huffman_codes = codigosDesdeFrecuencias(frequencies);
+        if (huffman_codes == NULL) {
+            fprintf(stderr, "Error: No se pudieron reconstruir los códigos\n");
+            return false;
+        }
+
+        // Un solo símbolo distinto: el árbol es una hoja y no hay bits que leer
+        int symbolCount = 0;
+        int lastSymbol = 0;
+        for (int i = 0; i < 256; i++) {
+            if (huffman_codes[i] != NULL) { symbolCount++; lastSymbol = i; }
+        }
+        if (symbolCount == 1 && huffman_codes[lastSymbol][0] == '\0') {
+            decoder->singleSymbol = lastSymbol;
+            liberarCodigos(huffman_codes);
+            return true;
+        }
+
+        if (codesFromStrings(huffman_codes, codes)) {
+            decoder->table = buildDecodeTable(codes);
+        }
+        liberarCodigos(huffman_codes);
+    }
+
+    if (decoder->table == NULL) {
+        fprintf(stderr, "Error: No se pudo crear la tabla de decodificación\n");
+        return false;
+    }
+    return true;
+}
+
+// HUFF_MODE_DICTIONARY: la tabla sale del diccionario cargado, que tiene que ser el mismo
+static bool prepareDictionaryTable(struct huffDecoder* decoder, unsigned int id) {
+    if (!dictionary.loaded) {
+        fprintf(stderr, "Error: el archivo se comprimió con el diccionario %08x (usar -D)\n", id);
+        return false;
+    }
+    if (dictionary.id != id) {
+        fprintf(stderr, "Error: el archivo necesita el diccionario %08x, pero el cargado es %08x\n", id,
+                dictionary.id);
+        return false;
+    }
+    return prepareDecoderTable(decoder, dictionary.lengths, NULL);
+}
+
+static void initDecoder(struct huffDecoder* decoder) {
+    memset(decoder, 0, sizeof(*decoder));
+    decoder->singleSymbol = -1;
+}
+
+/**
+ * @brief Lee el encabezado de un miembro que empieza en la posición actual de
+ * input y deja el archivo justo donde empiezan los datos. No abre nada.
+ * Los modos de bloques, sincronización y flujo leen su propio índice en runDecoder.
+ * @return false si el encabezado es inválido; igual hay que llamar a closeDecoder.
+ */
+bool openDecoderFile(struct huffDecoder* decoder, FILE* input) {
+    initDecoder(decoder);
+    decoder->file = input;
+    decoder->mode = readHeaderMode(input);
+    if (decoder->mode < 0) {
+        return false;
+    }
+    if (decoder->mode == HUFF_MODE_BLOCKS || decoder->mode == HUFF_MODE_INDEXED ||
+        decoder->mode == HUFF_MODE_STREAM || decoder->mode == HUFF_MODE_ADAPTIVE ||
+        decoder->mode == HUFF_MODE_TRANSFORM) {
+        return true;
+    }
+    if (decoder->mode != 0 && decoder->mode != HUFF_MODE_CANONICAL && decoder->mode != HUFF_MODE_CONTEXT &&
+        decoder->mode != HUFF_MODE_LZ && decoder->mode != HUFF_MODE_DICTIONARY &&
+        decoder->mode != HUFF_MODE_STORED) {
+        fprintf(stderr, "Error: modo de compresión %d no soportado\n", decoder->mode);
+        return false;
+    }
+
+    if (decoder->mode == HUFF_MODE_CONTEXT) {
+        if (fread(&decoder->total, sizeof(long long), 1, input) != 1 || decoder->total < 0 ||
+            (decoder->context = readContextModel(input)) == NULL) {
+            fprintf(stderr, "Error: encabezado inválido\n");
+            return false;
+        }
+        return true;
+    }
+    if (decoder->mode == HUFF_MODE_LZ) {
+        unsigned char lengths[HUFF_LZ_TABLES][256];
+        bool ok = fread(&decoder->total, sizeof(long long), 1, input) == 1 && decoder->total >= 0;
+        for (int t = 0; ok && t < HUFF_LZ_TABLES; t++) {
+            ok = readCodeLengths(input, lengths[t]);
+        }
+        if (!ok) {
+            fprintf(stderr, "Error: encabezado inválido\n");
+            return false;
+        }
+        return prepareLzTables(decoder, lengths);
+    }
+    if (decoder->mode == HUFF_MODE_CANONICAL) {
+        unsigned char lengths[256];
+        if (fread(&decoder->total, sizeof(long long), 1, input) != 1 || decoder->total < 0 ||
+            !readCodeLengths(input, lengths)) {
+            fprintf(stderr, "Error: encabezado inválido\n");
+            return false;
+        }
+        return prepareDecoderTable(decoder, lengths, NULL);
+    }
+    if (decoder->mode == HUFF_MODE_STORED) {
+        if (fread(&decoder->total, sizeof(long long), 1, input) != 1 || decoder->total < 0) {
+            fprintf(stderr, "Error: encabezado inválido\n");
+            return false;
+        }
+        return true;
+    }
+    if (decoder->mode == HUFF_MODE_DICTIONARY) {
+        unsigned int id;
+        if (fread(&decoder->total, sizeof(long long), 1, input) != 1 || decoder->total < 0 ||
+            fread(&id, sizeof(unsigned int), 1, input) != 1) {
+            fprintf(stderr, "Error: encabezado inválido\n");
+            return false;
+        }
+        return prepareDictionaryTable(decoder, id);
+    }
+
+    // Formato viejo: total y tabla de frecuencias
+    unsigned long long frequencies[256];
+    if (fread(&decoder->total, sizeof(long long), 1, input) != 1 || decoder->total <= 0) {
+        fprintf(stderr, "Error: Cantidad de caracteres inválida\n");
+        return false;
+    }
+    if (fread(frequencies, sizeof(unsigned long long), 256, input) != 256) {
+        fprintf(stderr, "Error al leer la tabla de frecuencias del encabezado.\n");
+        return false;
+    }
+    return prepareDecoderTable(decoder, NULL, frequencies);
+}
+
+/**
+ * @brief Lee el encabezado de un miembro completo que está en memoria. Los datos
+ * se decodifican desde el mismo buffer, que debe seguir vivo hasta closeDecoder.
+ * Solo para miembros canónicos, de contexto, LZ77, de diccionario o del formato viejo
+ * (un solo flujo de bits).
+ * @return false si el encabezado es inválido; igual hay que llamar a closeDecoder.
+ */
+bool openDecoderMemory(struct huffDecoder* decoder, const unsigned char* data, size_t size) {
+    initDecoder(decoder);
+    size_t position = 0;
+    if (size >= HUFF_MAGIC_SIZE + 1 && memcmp(data, HUFF_MAGIC, HUFF_MAGIC_SIZE) == 0) {
+        decoder->mode = data[HUFF_MAGIC_SIZE];
+        position = HUFF_MAGIC_SIZE + 1;
+    }
+    if (decoder->mode == HUFF_MODE_TRANSFORM) { // Se deshace entero en runDecoder
+        decoder->data = data + position;
+        decoder->size = size - position;
+        return true;
+    }
+    if (decoder->mode != 0 && decoder->mode != HUFF_MODE_CANONICAL && decoder->mode != HUFF_MODE_CONTEXT &&
+        decoder->mode != HUFF_MODE_LZ && decoder->mode != HUFF_MODE_DICTIONARY &&
+        decoder->mode != HUFF_MODE_STORED) {
+        fprintf(stderr, "Error: el modo %d no se puede decodificar desde memoria\n", decoder->mode);
+        return false;
+    }
+    if (size - position < sizeof(long long)) {
+        fprintf(stderr, "Error: encabezado inválido\n");
+        return false;
+    }
+    memcpy(&decoder->total, data + position, sizeof(long long));
+    position += sizeof(long long);
+
+    bool ok;
+    if (decoder->mode == HUFF_MODE_CONTEXT) {
+        if (decoder->total < 0 || (decoder->context = parseContextModel(data, size, &position)) == NULL) {
+            fprintf(stderr, "Error: encabezado inválido\n");
+            return false;
+        }
+        ok = true;
+    } else if (decoder->mode == HUFF_MODE_LZ) {
+        unsigned char lengths[HUFF_LZ_TABLES][256];
+        ok = decoder->total >= 0;
+        for (int t = 0; ok && t < HUFF_LZ_TABLES; t++) {
+            ok = parseCodeLengths(data, size, &position, lengths[t]);
+        }
+        if (!ok) {
+            fprintf(stderr, "Error: encabezado inválido\n");
+            return false;
+        }
+        ok = prepareLzTables(decoder, lengths);
+    } else if (decoder->mode == HUFF_MODE_CANONICAL) {
+        unsigned char lengths[256];
+        if (decoder->total < 0 || !parseCodeLengths(data, size, &position, lengths)) {
+            fprintf(stderr, "Error: encabezado inválido\n");
+            return false;
+        }
+        ok = prepareDecoderTable(decoder, lengths, NULL);
+    } else if (decoder->mode == HUFF_MODE_STORED) {
+        ok = decoder->total >= 0 && size - position == (unsigned long long)decoder->total;
+        if (!ok) {
+            fprintf(stderr, "Error: encabezado inválido\n");
+            return false;
+        }
+    } else if (decoder->mode == HUFF_MODE_DICTIONARY) {
+        unsigned int id;
+        if (decoder->total < 0 || size - position < sizeof(unsigned int)) {
+            fprintf(stderr, "Error: encabezado inválido\n");
+            return false;
+        }
+        memcpy(&id, data + position, sizeof(unsigned int));
+        position += sizeof(unsigned int);
+        ok = prepareDictionaryTable(decoder, id);
+    } else {
+        unsigned long long frequencies[256];
+        if (decoder->total <= 0 || size - position < sizeof(frequencies)) {
+            fprintf(stderr, "Error: encabezado inválido\n");
+            return false;
+        }
+        memcpy(frequencies, data + position, sizeof(frequencies));
+        position += sizeof(frequencies);
+        ok = prepareDecoderTable(decoder, NULL, frequencies);
+    }
+
+    decoder->data = data + position;
+    decoder->size = size - position;
+    return ok;
+}
+
+/**
+ * @brief Copia los datos de un miembro HUFF_MODE_STORED. Si la fuente es un archivo
+ * en el que se puede hacer seek, la copia la hace el kernel (copyFileBytes); desde
+ * un pipe o desde memoria se escribe con fwrite.
+ * @return La cantidad de caracteres copiados, o -1 si hubo un error.
+ */
+static long long copyStoredMember(struct huffDecoder* decoder, FILE* outputFile) {
+    long long total = decoder->total;
+    if (decoder->file == NULL) {
+        return fwrite(decoder->data, 1, total, outputFile) == (size_t)total ? total : -1;
+    }
+    long long start = ftell(decoder->file);
+    if (start >= 0 && lseek(fileno(outputFile), 0, SEEK_CUR) >= 0 && fflush(outputFile) == 0) {
+        bool ok = copyFileBytes(fileno(decoder->file), start, fileno(outputFile), total) &&
+                  fseek(decoder->file, start + total, SEEK_SET) == 0;
+        off_t end = lseek(fileno(outputFile), 0, SEEK_CUR); // El FILE* no vio la copia
+        return ok && end >= 0 && fseek(outputFile, end, SEEK_SET) == 0 ? total : -1;
+    }
+    unsigned char buffer[64 * 1024];
+    for (long long remaining = total; remaining > 0; ) {
+        size_t chunk = (remaining < (long long)sizeof(buffer)) ? (size_t)remaining : sizeof(buffer);
+        if (fread(buffer, 1, chunk, decoder->file) != chunk || fwrite(buffer, 1, chunk, outputFile) != chunk) {
+            return -1;
+        }
+        remaining -= chunk;
+    }
+    return total;
+}
+
+/**
+ * @brief Decodifica el miembro completo hacia outputFile.
+ * @return La cantidad de caracteres decodificados, o -1 si hubo un error.
+ */
+long long runDecoder(struct huffDecoder* decoder, FILE* outputFile) {
+    long long decoded = -1;
+
+    // Los modos por tramas reportan sus propios errores
+    if (decoder->mode == HUFF_MODE_STREAM) {
+        return decompressStreamFrames(decoder->file, outputFile);
+    }
+    if (decoder->mode == HUFF_MODE_ADAPTIVE) {
+        return decompressAdaptiveFrames(decoder->file, outputFile);
+    }
+    if (decoder->mode == HUFF_MODE_TRANSFORM) {
+        return decompressTransformed(decoder, outputFile);
+    }
+    if (decoder->mode == HUFF_MODE_BLOCKS || decoder->mode == HUFF_MODE_INDEXED) {
+        // Los hilos leen con pread: la entrada tiene que ser un archivo de verdad
+        if (lseek(fileno(decoder->file), 0, SEEK_CUR) < 0) {
+            fprintf(stderr, "Error: este modo necesita un archivo de entrada (no un pipe)\n");
+            return -1;
+        }
+        decoded = (decoder->mode == HUFF_MODE_BLOCKS)
+            ? decompressBlocks(decoder->file, outputFile)
+            : decompressIndexedMember(decoder->file, outputFile);
+    } else if (decoder->mode == HUFF_MODE_STORED) {
+        decoded = copyStoredMember(decoder, outputFile);
+    } else if (decoder->total == 0) {
+        decoded = 0;
+    } else if (decoder->mode == HUFF_MODE_LZ) {
+        decoded = decompressLzMember(decoder, outputFile);
+    } else if (decoder->singleSymbol >= 0) {
+        unsigned char block[4096];
+        memset(block, decoder->singleSymbol, sizeof(block));
+        for (long long remaining = decoder->total; remaining > 0; ) {
+            size_t chunk = (remaining < (long long)sizeof(block)) ? (size_t)remaining : sizeof(block);
+            fwrite(block, 1, chunk, outputFile);
+            remaining -= chunk;
+        }
+        decoded = decoder->total;
+    } else {
+        // Decodificar por tablas, escribiendo la salida en bloques
+        struct bitReader reader;
+        if (decoder->file != NULL) {
+            if (initBitReaderFile(&reader, decoder->file)) {
+                decoded = decodeSymbols(&reader, decoder, outputFile);
+            }
+        } else {
+            initBitReaderMemory(&reader, decoder->data, decoder->size);
+            decoded = decodeSymbols(&reader, decoder, outputFile);
+        }
+        closeBitReader(&reader);
+    }
+
+    if (decoded < 0) {
+        fprintf(stderr, "Error: datos comprimidos corruptos o incompletos\n");
+    }
+    return decoded;
+}
+
+void closeDecoder(struct huffDecoder* decoder) {
+    freeDecodeTable(decoder->table);
+    decoder->table = NULL;
+    freeContextModel(decoder->context);
+    decoder->context = NULL;
+    for (int t = 0; t < HUFF_LZ_TABLES - 1; t++) {
+        freeDecodeTable(decoder->lzTables[t]);
+        decoder->lzTables[t] = NULL;
+    }
+}
+
+/**
+ * @brief Descomprime un miembro que empieza en la posición actual de compressedFile.
+ * Sirve igual para un archivo suelto que para un miembro dentro de un contenedor.
+ * @return true si la descompresión fue exitosa, false en caso contrario
+ */
+bool decompressStream(FILE* compressedFile, FILE* outputFile) {
+    struct huffDecoder decoder;
+    long long decoded = -1;
+    if (openDecoderFile(&decoder, compressedFile)) {
+        decoded = runDecoder(&decoder, outputFile);
+    }
+    closeDecoder(&decoder);
+
+    if (decoded < 0) {
+        return false;
+    }
+    reportDecoded(outputFile, decoded);
+    return true;
+}
+
+/**
+ * @brief Descomprime un archivo que fue comprimido con el algoritmo de Huffman
+ * @param compressedFileName El nombre del archivo comprimido (.bin)
+ * @param outputFileName El nombre del archivo de salida descomprimido
+ * @return true si la descompresión fue exitosa, false en caso contrario
+ */
+bool decompressFile(const char* compressedFileName, const char* outputFileName) {
+    // "-" = stdin / stdout
+    bool fromStdin = strcmp(compressedFileName, "-") == 0;
+    bool toStdout = strcmp(outputFileName, "-") == 0;
+    FILE* compressedFile = fromStdin ? stdin : fopen(compressedFileName, "rb");
+    FILE* outputFile = toStdout ? stdout : fopen(outputFileName, "wb");
+    
+    // Verificar que los archivos se abrieron correctamente
+    if (compressedFile == NULL) {
+        perror("Error al abrir el archivo comprimido");
+        if (outputFile != NULL && !toStdout) fclose(outputFile);
+        return false;
+    }
+    if (outputFile == NULL) {
+        perror("Error al crear el archivo de salida");
+        if (!fromStdin) fclose(compressedFile);
+        return false;
+    }
+
+    bool ok = decompressStream(compressedFile, outputFile);
+    if (!ok) {
+        fprintf(stderr, "Error al descomprimir %s\n", compressedFileName);
+    }
+    if (!fromStdin) fclose(compressedFile);
+    if (toStdout) {
+        ok = fflush(stdout) == 0 && ok;
+    } else {
+        fclose(outputFile);
+    }
+    return ok;
+}
+
+/**
+ * @brief Crea un árbol de decodificación a partir de los códigos de Huffman
+ * @param huffman_codes Array de códigos de Huffman
+ * @return Puntero a la raíz del árbol de decodificación, o NULL si hay error
+ */
+
+struct treeNode* createDecodingTree(char** huffman_codes) {
+    struct treeNode* root = createNode('$', 0); // Nodo raíz interno
+    if (root == NULL) {
         return NULL;
     }
-    char path[256] = {0};
-    generateCodes(huffmanRoot, path, 0, huffman_codes);
+    
+    // Para cada carácter que tiene código
+    for (int i = 0; i < 256; i++) {
+        if (huffman_codes[i] != NULL) {
+            char* code = huffman_codes[i];
+            struct treeNode* currentNode = root;
+            
+            // Navegar/crear el camino en el árbol según el código
+            for (int j = 0; code[j] != '\0'; j++) {
+                if (code[j] == '0') {
+                    //izquierda
+                    if (currentNode->left == NULL) {
+                        currentNode->left = createNode('$', 0); //temporal
+                    }
+                    currentNode = currentNode->left;
+                } else if (code[j] == '1') {
+                    //derecha
+                    if (currentNode->right == NULL) {
+                        currentNode->right = createNode('$', 0); //temporal
+                    }
+                    currentNode = currentNode->right;
+                } else {
+                    // Código inválido
+                    fprintf(stderr, "Error: Código inválido encontrado\n");
+                    freeTree(root);
+                    return NULL;
+                }
+            }
+            
+            // Al final del código, establecer el carácter en la hoja
+            currentNode->value = (unsigned char)i;
+        }
+    }
+    
+    return root;
+}
+
+/**
+ * @brief Verifica si un archivo es un archivo de texto regular
+ * @param filepath Ruta completa del archivo
+ * @return true si es un archivo regular, false en caso contrario
+ */
+bool isRegularFile(const char* filepath) {
+    struct stat path_stat;
+    if (stat(filepath, &path_stat) != 0) {
+        return false;
+    }
+    return S_ISREG(path_stat.st_mode);
+}
+
+//--------------------------------------------------------------------------//
+//                                                                          //
+//          Contenedor de directorios con directorio central                //
+//                                                                          //
+//--------------------------------------------------------------------------//
+
+static unsigned int crcTable[256];
+static pthread_once_t crcTableOnce = PTHREAD_ONCE_INIT;
+
+static void initCrcTable() {
+    for (unsigned int i = 0; i < 256; i++) {
+        unsigned int crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+        }
+        crcTable[i] = crc;
+    }
+}
+
+/**
+ * @brief Actualiza un CRC32 (el mismo de zip/gzip) con un bloque de bytes.
+ * Empezar con crc = 0.
+ */
+unsigned int crc32Update(unsigned int crc, const unsigned char* data, size_t size) {
+    pthread_once(&crcTableOnce, initCrcTable);
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc = crcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Escribe el encabezado del contenedor: marca y versión.
+ */
+void writeArchiveHeader(FILE* output) {
+    unsigned char version = ARCHIVE_VERSION;
+    fwrite(ARCHIVE_MAGIC, 1, ARCHIVE_MAGIC_SIZE, output);
+    fwrite(&version, 1, 1, output);
+}
+
+// Agrega una entrada al directorio en memoria
+static bool addArchiveEntry(struct archiveDirectory* directory, const char* name, long long offset,
+                            long long originalSize, long long compressedSize, unsigned int checksum) {
+    if (directory->count == directory->capacity) {
+        int newCapacity = (directory->capacity == 0) ? 16 : directory->capacity * 2;
+        struct archiveEntry* grown = realloc(directory->entries, newCapacity * sizeof(struct archiveEntry));
+        if (grown == NULL) return false;
+        directory->entries = grown;
+        directory->capacity = newCapacity;
+    }
+    struct archiveEntry* entry = &directory->entries[directory->count];
+    entry->name = strdup(name);
+    if (entry->name == NULL) return false;
+    entry->offset = offset;
+    entry->originalSize = originalSize;
+    entry->compressedSize = compressedSize;
+    entry->checksum = checksum;
+    entry->group = -1;
+    directory->count++;
+    return true;
+}
+
+// CRC32 de un rango del archivo, leído con pread (no mueve la posición del FILE*)
+static bool checksumFileRange(int fd, long long offset, long long size, unsigned int* checksum) {
+    unsigned char buffer[1 << 16];
+    *checksum = 0;
+    while (size > 0) {
+        size_t chunk = (size < (long long)sizeof(buffer)) ? (size_t)size : sizeof(buffer);
+        ssize_t bytesRead = pread(fd, buffer, chunk, offset);
+        if (bytesRead <= 0) return false;
+        *checksum = crc32Update(*checksum, buffer, bytesRead);
+        offset += bytesRead;
+        size -= bytesRead;
+    }
+    return true;
+}
+
+/**
+ * @brief Agrega al final del contenedor un miembro ya comprimido en memoria
+ * y lo registra en el directorio con su posición, tamaños y CRC32.
+ * @param originalSize Tamaño del archivo original.
+ * @return false si no se pudo escribir.
+ */
+bool appendArchiveMember(FILE* output, struct archiveDirectory* directory, const char* name,
+                         const unsigned char* data, size_t size, long long originalSize) {
+    long long offset = ftell(output);
+    if (fwrite(data, 1, size, output) != size) {
+        perror("Error al escribir el archivo de salida");
+        return false;
+    }
+    unsigned int checksum = crc32Update(0, data, size);
+    return addArchiveEntry(directory, name, offset, originalSize, (long long)size, checksum);
+}
+
+// Cierra un miembro escrito en [offset, posición actual): lo recorta si falló, o
+// calcula su CRC32 (salvo que ya se conozca) y lo agrega al directorio
+static bool registerWrittenMember(FILE* output, struct archiveDirectory* directory, const char* name,
+                                  long long offset, long long originalSize, bool written,
+                                  const unsigned int* knownChecksum) {
+    if (!written || fflush(output) != 0) {
+        // Descartar lo que haya quedado a medias
+        fflush(output);
+        if (ftruncate(fileno(output), offset) != 0) {
+            perror("Error al recortar el archivo de salida");
+        }
+        fseek(output, offset, SEEK_SET);
+        return false;
+    }
+    long long compressedSize = ftell(output) - offset;
+    unsigned int checksum;
+    if (knownChecksum != NULL) {
+        checksum = *knownChecksum;
+    } else if (!checksumFileRange(fileno(output), offset, compressedSize, &checksum)) {
+        perror("Error al releer el miembro comprimido");
+        return false;
+    }
+    return addArchiveEntry(directory, name, offset, originalSize, compressedSize, checksum);
+}
+
+/**
+ * @brief Comprime un archivo directo al final del contenedor (sin temporales) y lo
+ * registra en el directorio. El CRC32 se calcula releyendo el rango recién escrito,
+ * que todavía está en la caché de páginas; el de los miembros guardados sin comprimir
+ * ya viene calculado sobre la entrada mapeada (una lectura, en vez de dos).
+ * @param output Contenedor abierto con "wb+" (hace falta poder leerlo).
+ * @return false si no se pudo comprimir.
+ */
+bool compressArchiveMember(FILE* output, struct archiveDirectory* directory, const char* name,
+                           const char* inputPath) {
+    long long offset = ftell(output);
+    long long originalSize = 0;
+    bool checksumKnown = false;
+    unsigned int checksum;
+    bool written = compressFileMember(inputPath, output, &originalSize, &checksumKnown, &checksum);
+    return registerWrittenMember(output, directory, name, offset, originalSize, written,
+                                 checksumKnown ? &checksum : NULL);
+}
+
+/**
+ * @brief Registra en el directorio un miembro que otro ya escribió en el contenedor,
+ * desde offset hasta la posición actual (por ejemplo un contenedor por bloques armado
+ * de a un bloque). El CRC32 se calcula releyendo el rango.
+ * @param written false si la escritura falló: se recorta lo que haya quedado a medias.
+ * @return false si el miembro no quedó registrado.
+ */
+bool finishArchiveMember(FILE* output, struct archiveDirectory* directory, const char* name,
+                         long long offset, long long originalSize, bool written) {
+    return registerWrittenMember(output, directory, name, offset, originalSize, written, NULL);
+}
+
+// Si está activo, compressDirectory junta los archivos chicos en grupos sólidos
+static bool solidGroups = false;
+
+/**
+ * @brief Activa o desactiva los grupos sólidos (HUFF_MODE_SOLID) en compressDirectory.
+ * Al descomprimir no hace falta: cada entrada dice si está en un grupo.
+ */
+void setSolidGroups(bool enabled) {
+    solidGroups = enabled;
+}
+
+// Lee un archivo completo al final de buffer (que crece si hace falta)
+static bool appendFileContents(const char* path, unsigned char** buffer, size_t* size, size_t* capacity) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = true;
+    while (ok) {
+        if (*size == *capacity) {
+            size_t grown = (*capacity == 0) ? HUFF_SOLID_MEMBER_MAX : *capacity * 2;
+            unsigned char* larger = (unsigned char*)realloc(*buffer, grown);
+            if (larger == NULL) { ok = false; break; }
+            *buffer = larger;
+            *capacity = grown;
+        }
+        ssize_t bytesRead = read(fd, *buffer + *size, *capacity - *size);
+        if (bytesRead < 0) ok = false;
+        if (bytesRead <= 0) break;
+        *size += bytesRead;
+    }
+    close(fd);
+    return ok;
+}
+
+// Compara el tamaño del grupo (una tabla + los bits de todos) con la suma de los
+// miembros canónicos que saldrían de cada archivo por separado (o guardados tal
+// cual, que es lo que queda si el canónico no achica)
+static bool solidGroupWins(const unsigned char* data, const size_t* starts, const bool* readable, int count,
+                           const unsigned long long* frequencies, const unsigned char* lengths) {
+    unsigned long long bits = 0;
+    for (int i = 0; i < 256; i++) {
+        bits += frequencies[i] * lengths[i];
+    }
+    unsigned long long groupSize = HUFF_MAGIC_SIZE + 1 + sizeof(int) + sizeof(long long) +
+                                   codeLengthsSize(lengths) + (bits + 7) / 8;
+    unsigned long long separateSize = 0;
+    for (int i = 0; i < count && separateSize < groupSize; i++) {
+        if (!readable[i]) continue;
+        size_t memberSize = starts[i + 1] - starts[i];
+        unsigned long long canonicalSize = canonicalMemberSize(data + starts[i], memberSize);
+        unsigned long long storedSize = STORED_HEADER_SIZE + memberSize;
+        separateSize += (canonicalSize < storedSize) ? canonicalSize : storedSize;
+    }
+    return groupSize <= separateSize;
+}
+
+/**
+ * @brief Comprime varios archivos chicos como un grupo sólido (HUFF_MODE_SOLID):
+ * una sola tabla para todos y los miembros uno detrás de otro en el mismo flujo
+ * de bits. Cada archivo queda en el directorio con su rango de bits, así se
+ * puede extraer solo sin decodificar el resto del grupo. Si los archivos salen
+ * más chicos cada uno con su tabla, se escriben como miembros comunes.
+ * @param files Archivos del grupo (los que no se pueden leer se saltan con un aviso).
+ * @return false si no se pudo escribir el grupo (o alguno de los miembros comunes).
+ */
+bool compressArchiveGroup(FILE* output, struct archiveDirectory* directory,
+                          const struct walkEntry* files, int count) {
+    unsigned char* data = NULL;
+    size_t size = 0, capacity = 0;
+    size_t* starts = (size_t*)malloc((count + 1) * sizeof(size_t));
+    bool* readable = (bool*)malloc((count > 0 ? count : 1) * sizeof(bool));
+    struct bitWriter* writer = (struct bitWriter*)malloc(sizeof(struct bitWriter));
+    if (starts == NULL || readable == NULL || writer == NULL) {
+        perror("Fallo de memoria para el grupo");
+        free(starts); free(readable); free(writer);
+        return false;
+    }
+    int memberCount = 0;
+    for (int i = 0; i < count; i++) {
+        starts[i] = size;
+        readable[i] = appendFileContents(files[i].path, &data, &size, &capacity);
+        if (!readable[i]) {
+            fprintf(stderr, "Error al abrir archivo de entrada: %s\n", files[i].path);
+            size = starts[i];
+        } else {
+            memberCount++;
+        }
+    }
+    starts[count] = size;
+
+    // Una tabla para todo el grupo (un grupo de archivos vacíos igual necesita un código)
+    unsigned long long frequencies[256] = { 0 };
+    unsigned char lengths[256];
+    struct huffCode codes[256];
+    countFrequencies(data, size, frequencies);
+    if (size == 0) frequencies[0] = 1;
+    bool ok = codeLengthsFromFrequencies(frequencies, lengths) && assignCanonicalCodes(lengths, codes);
+
+    // Si una tabla por archivo sale más barata que la tabla compartida, el grupo
+    // no sirve: cada archivo va como miembro común
+    if (ok && !solidGroupWins(data, starts, readable, count, frequencies, lengths)) {
+        printf("  El grupo no achica: se comprime archivo por archivo\n");
+        free(data);
+        free(starts);
+        free(writer);
+        bool written = true;
+        for (int i = 0; i < count; i++) {
+            if (readable[i] && !compressArchiveMember(output, directory, files[i].name, files[i].path)) {
+                written = false;
+            }
+        }
+        free(readable);
+        return written;
+    }
+
+    long long group = ftell(output);
+    long long total = (long long)size;
+    if (ok) {
+        fwrite(HUFF_MAGIC, 1, HUFF_MAGIC_SIZE, output);
+        fputc(HUFF_MODE_SOLID, output);
+        fwrite(&memberCount, sizeof(int), 1, output);
+        fwrite(&total, sizeof(long long), 1, output);
+        writeCodeLengths(output, lengths);
+
+        initBitWriter(writer, output);
+        for (int i = 0; ok && i < count; i++) {
+            if (!readable[i]) continue;
+            unsigned long long firstBit = bitWriterPosition(writer);
+            for (size_t k = starts[i]; k < starts[i + 1]; k++) {
+                putCode(writer, codes[data[k]]);
+            }
+            size_t memberSize = starts[i + 1] - starts[i];
+            ok = addArchiveEntry(directory, files[i].name, (long long)firstBit, (long long)memberSize,
+                                 (long long)(bitWriterPosition(writer) - firstBit),
+                                 crc32Update(0, data + starts[i], memberSize));
+            if (ok) directory->entries[directory->count - 1].group = group;
+        }
+        finishBitWriter(writer);
+        ok = ok && fflush(output) == 0;
+    }
+
+    free(data);
+    free(starts);
+    free(readable);
+    free(writer);
+    return ok;
+}
+
+/**
+ * @brief Escribe el directorio central y la cola al final del contenedor.
+ * Por miembro: [int largo del nombre][nombre][long long posición]
+ * [long long tamaño original][long long tamaño comprimido][unsigned int CRC32][long long grupo]
+ * Cola: [long long posición del directorio][int cantidad][char[4] "HFMD"]
+ */
+bool writeArchiveDirectory(FILE* output, const struct archiveDirectory* directory) {
+    long long directoryOffset = ftell(output);
+    for (int i = 0; i < directory->count; i++) {
+        const struct archiveEntry* entry = &directory->entries[i];
+        int nameLength = strlen(entry->name);
+        fwrite(&nameLength, sizeof(int), 1, output);
+        fwrite(entry->name, sizeof(char), nameLength, output);
+        fwrite(&entry->offset, sizeof(long long), 1, output);
+        fwrite(&entry->originalSize, sizeof(long long), 1, output);
+        fwrite(&entry->compressedSize, sizeof(long long), 1, output);
+        fwrite(&entry->checksum, sizeof(unsigned int), 1, output);
+        fwrite(&entry->group, sizeof(long long), 1, output);
+    }
+    fwrite(&directoryOffset, sizeof(long long), 1, output);
+    fwrite(&directory->count, sizeof(int), 1, output);
+    return fwrite(ARCHIVE_TRAILER_MAGIC, 1, ARCHIVE_MAGIC_SIZE, output) == ARCHIVE_MAGIC_SIZE;
+}
+
+// Lee un nombre de miembro [int largo][bytes] validando el largo
+static bool readEntryName(FILE* input, char* name) {
+    int nameLength;
+    if (fread(&nameLength, sizeof(int), 1, input) != 1) return false;
+    if (nameLength <= 0 || nameLength > ARCHIVE_MAX_NAME) {
+        fprintf(stderr, "Error: Longitud de nombre inválida: %d\n", nameLength);
+        return false;
+    }
+    if (fread(name, sizeof(char), nameLength, input) != (size_t)nameLength) return false;
+    name[nameLength] = '\0';
+    return true;
+}
+
+// Formato viejo: [int cantidad] y luego (nombre, tamaño, datos) seguidos; hay que recorrerlo
+static bool readLegacyDirectory(FILE* input, struct archiveDirectory* directory) {
+    int fileCount;
+    if (fseek(input, 0, SEEK_SET) != 0 || fread(&fileCount, sizeof(int), 1, input) != 1 || fileCount < 0) {
+        fprintf(stderr, "Error al leer el número de archivos\n");
+        return false;
+    }
+    for (int i = 0; i < fileCount; i++) {
+        char name[ARCHIVE_MAX_NAME + 1];
+        long long compressedSize;
+        if (!readEntryName(input, name) ||
+            fread(&compressedSize, sizeof(long long), 1, input) != 1 || compressedSize < 0) {
+            fprintf(stderr, "Error al leer los metadatos del archivo %d\n", i + 1);
+            return false;
+        }
+        long long offset = ftell(input);
+        if (!addArchiveEntry(directory, name, offset, -1, compressedSize, 0)) return false;
+        fseek(input, compressedSize, SEEK_CUR);
+    }
+    return true;
+}
+
+/**
+ * @brief Carga el directorio de un contenedor. Con el formato nuevo son dos
+ * lecturas (cola y directorio central); el formato viejo se recorre completo.
+ * @return false si el archivo no es un contenedor válido.
+ */
+bool readArchiveDirectory(FILE* input, struct archiveDirectory* directory) {
+    directory->version = 0;
+    directory->count = 0;
+    directory->capacity = 0;
+    directory->entries = NULL;
+
+    char magic[ARCHIVE_MAGIC_SIZE];
+    unsigned char version;
+    if (fread(magic, 1, ARCHIVE_MAGIC_SIZE, input) != ARCHIVE_MAGIC_SIZE ||
+        memcmp(magic, ARCHIVE_MAGIC, ARCHIVE_MAGIC_SIZE) != 0) {
+        return readLegacyDirectory(input, directory);
+    }
+    if (fread(&version, 1, 1, input) != 1 || version > ARCHIVE_VERSION) {
+        fprintf(stderr, "Error: versión de contenedor no soportada\n");
+        return false;
+    }
+    directory->version = version;
+
+    // Cola: posición del directorio, cantidad y marca
+    long long directoryOffset;
+    int count;
+    char trailer[ARCHIVE_MAGIC_SIZE];
+    long trailerSize = sizeof(long long) + sizeof(int) + ARCHIVE_MAGIC_SIZE;
+    if (fseek(input, -trailerSize, SEEK_END) != 0 ||
+        fread(&directoryOffset, sizeof(long long), 1, input) != 1 ||
+        fread(&count, sizeof(int), 1, input) != 1 ||
+        fread(trailer, 1, ARCHIVE_MAGIC_SIZE, input) != ARCHIVE_MAGIC_SIZE ||
+        memcmp(trailer, ARCHIVE_TRAILER_MAGIC, ARCHIVE_MAGIC_SIZE) != 0 || count < 0) {
+        fprintf(stderr, "Error: el contenedor está incompleto (sin directorio central)\n");
+        return false;
+    }
+
+    if (fseek(input, directoryOffset, SEEK_SET) != 0) return false;
+    for (int i = 0; i < count; i++) {
+        char name[ARCHIVE_MAX_NAME + 1];
+        long long offset, originalSize, compressedSize;
+        long long group = -1;
+        unsigned int checksum;
+        if (!readEntryName(input, name) ||
+            fread(&offset, sizeof(long long), 1, input) != 1 ||
+            fread(&originalSize, sizeof(long long), 1, input) != 1 ||
+            fread(&compressedSize, sizeof(long long), 1, input) != 1 ||
+            fread(&checksum, sizeof(unsigned int), 1, input) != 1 ||
+            (version >= 2 && fread(&group, sizeof(long long), 1, input) != 1) ||
+            !addArchiveEntry(directory, name, offset, originalSize, compressedSize, checksum)) {
+            fprintf(stderr, "Error al leer la entrada %d del directorio central\n", i + 1);
+            return false;
+        }
+        directory->entries[i].group = group;
+    }
+    return true;
+}
 
-    // --- Limpiar ---
-    free(letters);      
-    freeTree(huffmanRoot); // Usar esta función para borrar el arbol!
+void freeArchiveDirectory(struct archiveDirectory* directory) {
+    for (int i = 0; i < directory->count; i++) {
+        free(directory->entries[i].name);
+    }
+    free(directory->entries);
+    directory->entries = NULL;
+    directory->count = 0;
+    directory->capacity = 0;
+}
 
+/**
+ * @brief Busca un miembro por nombre en el directorio.
+ * @return La entrada, o NULL si no existe.
+ */
+const struct archiveEntry* findArchiveEntry(const struct archiveDirectory* directory, const char* name) {
+    for (int i = 0; i < directory->count; i++) {
+        if (strcmp(directory->entries[i].name, name) == 0) {
+            return &directory->entries[i];
+        }
+    }
+    return NULL;
+}
 
-    return huffman_codes;
+// Un nombre de miembro es una ruta relativa que no puede salirse del directorio de extracción
+static bool isSafeMemberName(const char* name) {
+    if (name[0] == '/') return false;
+    const char* part = name;
+    while (true) {
+        const char* slash = strchr(part, '/');
+        size_t length = (slash != NULL) ? (size_t)(slash - part) : strlen(part);
+        if (length == 0 || (length == 2 && part[0] == '.' && part[1] == '.')) return false;
+        if (slash == NULL) return true;
+        part = slash + 1;
+    }
 }
-/** 
- * @brief para limpiar la memoria de la tabla de codigos, importante cuando tenga que paralelizarse todo después.
-*/
-void liberarCodigos(char** codes){
-    if (codes == NULL) { return; }
 
-    for (int i = 0; i < 256; i++) {
-        if (codes[i] != NULL) {
-            free(codes[i]); // Libera la memoria del string
+// Crea los subdirectorios del miembro (lo que está después del directorio de
+// extracción en outputPath); otro hilo o proceso puede estar creando los mismos
+static bool createMemberDirectories(const char* outputPath, const char* name) {
+    size_t pathLength = strlen(outputPath);
+    size_t nameLength = strlen(name);
+    if (strchr(name, '/') == NULL || nameLength > pathLength) {
+        return true;
+    }
+    char* path = strdup(outputPath);
+    if (path == NULL) return false;
+    bool ok = true;
+    for (char* slash = strchr(path + pathLength - nameLength, '/'); ok && slash != NULL; slash = strchr(slash + 1, '/')) {
+        *slash = '\0';
+        if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+            perror("Error al crear directorio");
+            ok = false;
         }
+        *slash = '/';
     }
-    free(codes);
+    free(path);
+    return ok;
 }
 
+// Encabezado de un grupo: marca, modo, cantidad, total y longitudes RLE (a lo sumo 2 bytes por símbolo)
+#define SOLID_HEADER_MAX (HUFF_MAGIC_SIZE + 1 + sizeof(int) + sizeof(long long) + 512)
+
 /**
- * @brief Descomprime un archivo que fue comprimido con el algoritmo de Huffman
- * @param compressedFileName El nombre del archivo comprimido (.bin)
- * @param outputFileName El nombre del archivo de salida descomprimido
- * @return true si la descompresión fue exitosa, false en caso contrario
+ * @brief Extrae un miembro de un grupo sólido: lee el encabezado del grupo y solo
+ * los bytes del rango de bits del miembro, y verifica el CRC32 de lo decodificado.
  */
-bool decompressFile(const char* compressedFileName, const char* outputFileName) {
-    FILE* compressedFile = fopen(compressedFileName, "rb");
-    FILE* outputFile = fopen(outputFileName, "w");
-    
-    // Verificar que los archivos se abrieron correctamente
-    if (compressedFile == NULL) {
-        perror("Error al abrir el archivo comprimido");
+static bool extractGroupedMember(FILE* input, const struct archiveEntry* entry, const char* outputPath) {
+    int fd = fileno(input);
+    unsigned char header[SOLID_HEADER_MAX];
+    ssize_t headerSize = pread(fd, header, sizeof(header), entry->group);
+    unsigned char lengths[256];
+    size_t position = HUFF_MAGIC_SIZE + 1 + sizeof(int) + sizeof(long long);
+    struct huffCode codes[256];
+    struct decodeTable* table = NULL;
+    if (headerSize < (ssize_t)position || memcmp(header, HUFF_MAGIC, HUFF_MAGIC_SIZE) != 0 ||
+        header[HUFF_MAGIC_SIZE] != HUFF_MODE_SOLID || entry->offset < 0 || entry->compressedSize < 0 ||
+        entry->originalSize < 0 || !parseCodeLengths(header, headerSize, &position, lengths) ||
+        !assignCanonicalCodes(lengths, codes) || (table = buildDecodeTable(codes)) == NULL) {
+        fprintf(stderr, "Error: grupo inválido para %s\n", entry->name);
         return false;
     }
-    if (outputFile == NULL) {
-        perror("Error al crear el archivo de salida");
-        fclose(compressedFile);
+
+    // Solo los bytes que tocan el rango de bits del miembro
+    int skipBits = (int)(entry->offset % 8);
+    size_t bytes = (size_t)((skipBits + entry->compressedSize + 7) / 8);
+    unsigned char* bits = (unsigned char*)malloc(bytes > 0 ? bytes : 1);
+    unsigned char* out = (unsigned char*)malloc(entry->originalSize > 0 ? entry->originalSize : 1);
+    bool ok = bits != NULL && out != NULL &&
+              pread(fd, bits, bytes, entry->group + (long long)position + entry->offset / 8) == (ssize_t)bytes &&
+              decodeSymbolsFromMemory(table, bits, bytes, skipBits, out, entry->originalSize);
+    freeDecodeTable(table);
+    free(bits);
+    if (!ok || crc32Update(0, out, entry->originalSize) != entry->checksum) {
+        fprintf(stderr, "Error: CRC32 incorrecto en %s (archivo dañado)\n", entry->name);
+        free(out);
         return false;
     }
-    
-    // 1. Leer los metadatos del archivo
-    long long total_chars = obtenerCantidadDeCaracteres(compressedFileName);
-    if (total_chars <= 0) {
-        fprintf(stderr, "Error: Cantidad de caracteres inválida\n");
-        fclose(compressedFile);
-        fclose(outputFile);
+
+    FILE* outputFile = createMemberDirectories(outputPath, entry->name) ? fopen(outputPath, "wb") : NULL;
+    if (outputFile == NULL) {
+        perror("Error al crear el archivo de salida");
+        free(out);
         return false;
     }
-    
-    // 2. Reconstruir los códigos de Huffman
-    char** huffman_codes = reconstruirCodigos(compressedFileName);
-    if (huffman_codes == NULL) {
-        fprintf(stderr, "Error: No se pudieron reconstruir los códigos\n");
-        fclose(compressedFile);
-        fclose(outputFile);
+    ok = fwrite(out, 1, entry->originalSize, outputFile) == (size_t)entry->originalSize;
+    if (ok) reportDecoded(outputFile, entry->originalSize);
+    fclose(outputFile);
+    free(out);
+    return ok;
+}
+
+/**
+ * @brief Extrae un miembro HUFF_MODE_STORED en una sola pasada: cada tramo se lee
+ * con pread, se suma al CRC32 y se escribe. Verificar el CRC obliga a leer los
+ * datos de todos modos, así que no se usa copy_file_range. Si el CRC no coincide
+ * se borra lo extraído.
+ */
+static bool extractStoredMember(FILE* input, const struct archiveEntry* entry, const char* outputPath) {
+    int fd = fileno(input);
+    long long size = entry->compressedSize - (long long)STORED_HEADER_SIZE;
+    if (size != entry->originalSize) {
+        fprintf(stderr, "Error: miembro guardado inválido: %s\n", entry->name);
         return false;
     }
-    
-    // 3. Crear el árbol de decodificación inverso
-    struct treeNode* decodingTree = createDecodingTree(huffman_codes);
-    if (decodingTree == NULL) {
-        fprintf(stderr, "Error: No se pudo crear el árbol de decodificación\n");
-        liberarCodigos(huffman_codes);
-        fclose(compressedFile);
-        fclose(outputFile);
+    FILE* outputFile = createMemberDirectories(outputPath, entry->name) ? fopen(outputPath, "wb") : NULL;
+    if (outputFile == NULL) {
+        perror("Error al crear el archivo de salida");
         return false;
     }
-    
-    // 4. Posicionarse al inicio de los datos comprimidos
-    long offset = sizeof(long long) + 256 * sizeof(unsigned long long);
-    fseek(compressedFile, offset, SEEK_SET);
-    
-    // 5. Decodificar bit por bit
-    struct treeNode* currentNode = decodingTree;
-    long long chars_decoded = 0;
-    int byte;
-    
-    while (chars_decoded < total_chars && (byte = fgetc(compressedFile)) != EOF) {
-        // Procesar cada bit del byte (de izquierda a derecha)
-        for (int bit_pos = 7; bit_pos >= 0 && chars_decoded < total_chars; bit_pos--) {
-            // Extraer el bit en la posición bit_pos
-            int bit = (byte >> bit_pos) & 1;
-            
-            // Navegar por el árbol
-            if (bit == 0) {
-                currentNode = currentNode->left;
-            } else {
-                currentNode = currentNode->right;
-            }
-            
-            // Si llegamos a una hoja, encontramos un carácter
-            if (currentNode->left == NULL && currentNode->right == NULL) {
-                fputc(currentNode->value, outputFile);
-                chars_decoded++;
-                currentNode = decodingTree; // Volver a la raíz
-            }
+    unsigned char header[STORED_HEADER_SIZE];
+    storedHeader(header, (size_t)size);
+    unsigned int checksum = crc32Update(0, header, STORED_HEADER_SIZE);
+    unsigned char buffer[1 << 16];
+    long long offset = entry->offset + (long long)STORED_HEADER_SIZE;
+    bool ok = true;
+    for (long long remaining = size; ok && remaining > 0; ) {
+        size_t chunk = (remaining < (long long)sizeof(buffer)) ? (size_t)remaining : sizeof(buffer);
+        ssize_t got = pread(fd, buffer, chunk, offset);
+        ok = got > 0 && fwrite(buffer, 1, got, outputFile) == (size_t)got;
+        if (ok) {
+            checksum = crc32Update(checksum, buffer, got);
+            offset += got;
+            remaining -= got;
         }
     }
-    
-    // 6. Limpieza
-    liberarCodigos(huffman_codes);
-    freeTree(decodingTree);
-    fclose(compressedFile);
-    fclose(outputFile);
-    
-    printf("Descompresión completada: %lld caracteres decodificados\n", chars_decoded);
+    if (!ok) {
+        fprintf(stderr, "Error al leer datos del archivo: %s\n", entry->name);
+    } else if (checksum != entry->checksum) {
+        fprintf(stderr, "Error: CRC32 incorrecto en %s (archivo dañado)\n", entry->name);
+        ok = false;
+    } else {
+        reportDecoded(outputFile, size);
+    }
+    if (fclose(outputFile) != 0 || !ok) {
+        unlink(outputPath);
+        return false;
+    }
     return true;
 }
 
 /**
- * @brief Crea un árbol de decodificación a partir de los códigos de Huffman
- * @param huffman_codes Array de códigos de Huffman
- * @return Puntero a la raíz del árbol de decodificación, o NULL si hay error
+ * @brief Extrae y descomprime un miembro sin copiarlo a un temporal. Los miembros
+ * guardados sin comprimir se copian en una pasada (extractStoredMember). Los miembros
+ * chicos se leen con un solo pread, se les verifica el CRC32 y se decodifican
+ * desde ese mismo buffer; los grandes se verifican por rangos y se decodifican
+ * directo desde el contenedor.
+ * @param input Contenedor abierto; cada hilo/proceso debe usar su propio FILE*.
  */
-
-struct treeNode* createDecodingTree(char** huffman_codes) {
-    struct treeNode* root = createNode('$', 0); // Nodo raíz interno
-    if (root == NULL) {
-        return NULL;
+bool extractArchiveMember(FILE* input, const struct archiveEntry* entry, const char* outputPath) {
+    if (!isSafeMemberName(entry->name)) {
+        fprintf(stderr, "Error: nombre de miembro inválido: %s\n", entry->name);
+        return false;
     }
-    
-    // Para cada carácter que tiene código
-    for (int i = 0; i < 256; i++) {
-        if (huffman_codes[i] != NULL) {
-            char* code = huffman_codes[i];
-            struct treeNode* currentNode = root;
-            
-            // Navegar/crear el camino en el árbol según el código
-            for (int j = 0; code[j] != '\0'; j++) {
-                if (code[j] == '0') {
-                    //izquierda
-                    if (currentNode->left == NULL) {
-                        currentNode->left = createNode('$', 0); //temporal
-                    }
-                    currentNode = currentNode->left;
-                } else if (code[j] == '1') {
-                    //derecha
-                    if (currentNode->right == NULL) {
-                        currentNode->right = createNode('$', 0); //temporal
-                    }
-                    currentNode = currentNode->right;
-                } else {
-                    // Código inválido
-                    fprintf(stderr, "Error: Código inválido encontrado\n");
-                    freeTree(root);
-                    return NULL;
-                }
-            }
-            
-            // Al final del código, establecer el carácter en la hoja
-            currentNode->value = (unsigned char)i;
+    if (entry->group >= 0) {
+        return extractGroupedMember(input, entry, outputPath);
+    }
+    unsigned char header[HUFF_MAGIC_SIZE + 1];
+    if (entry->originalSize >= 0 && entry->compressedSize >= (long long)STORED_HEADER_SIZE &&
+        pread(fileno(input), header, sizeof(header), entry->offset) == (ssize_t)sizeof(header) &&
+        memcmp(header, HUFF_MAGIC, HUFF_MAGIC_SIZE) == 0 && header[HUFF_MAGIC_SIZE] == HUFF_MODE_STORED) {
+        return extractStoredMember(input, entry, outputPath);
+    }
+    unsigned char* member = NULL;
+    if (entry->compressedSize <= ARCHIVE_INLINE_MEMBER_MAX) {
+        member = (unsigned char*)malloc(entry->compressedSize > 0 ? entry->compressedSize : 1);
+        if (member == NULL || pread(fileno(input), member, entry->compressedSize, entry->offset) !=
+                              (ssize_t)entry->compressedSize) {
+            fprintf(stderr, "Error al leer datos comprimidos del archivo: %s\n", entry->name);
+            free(member);
+            return false;
+        }
+        // Los miembros por bloques o con puntos de sincronización se decodifican en paralelo desde el archivo
+        if (entry->compressedSize > HUFF_MAGIC_SIZE && memcmp(member, HUFF_MAGIC, HUFF_MAGIC_SIZE) == 0 &&
+            (member[HUFF_MAGIC_SIZE] == HUFF_MODE_BLOCKS || member[HUFF_MAGIC_SIZE] == HUFF_MODE_INDEXED)) {
+            free(member);
+            member = NULL;
         }
     }
-    
-    return root;
-}
 
-/**
- * @brief Verifica si un archivo es un archivo de texto regular
- * @param filepath Ruta completa del archivo
- * @return true si es un archivo regular, false en caso contrario
- */
-bool isRegularFile(const char* filepath) {
-    struct stat path_stat;
-    if (stat(filepath, &path_stat) != 0) {
+    // El formato viejo no tiene CRC
+    if (entry->originalSize >= 0) {
+        unsigned int checksum;
+        if (member != NULL) {
+            checksum = crc32Update(0, member, entry->compressedSize);
+        } else if (!checksumFileRange(fileno(input), entry->offset, entry->compressedSize, &checksum)) {
+            fprintf(stderr, "Error al leer datos comprimidos del archivo: %s\n", entry->name);
+            return false;
+        }
+        if (checksum != entry->checksum) {
+            fprintf(stderr, "Error: CRC32 incorrecto en %s (archivo dañado)\n", entry->name);
+            free(member);
+            return false;
+        }
+    }
+
+    if (member == NULL && fseek(input, entry->offset, SEEK_SET) != 0) {
+        fprintf(stderr, "Error al buscar el miembro: %s\n", entry->name);
         return false;
     }
-    return S_ISREG(path_stat.st_mode);
+    FILE* outputFile = createMemberDirectories(outputPath, entry->name) ? fopen(outputPath, "wb") : NULL;
+    if (outputFile == NULL) {
+        perror("Error al crear el archivo de salida");
+        free(member);
+        return false;
+    }
+
+    bool ok;
+    if (member != NULL) {
+        struct huffDecoder decoder;
+        ok = openDecoderMemory(&decoder, member, entry->compressedSize) &&
+             runDecoder(&decoder, outputFile) >= 0;
+        closeDecoder(&decoder);
+        free(member);
+        if (ok) reportDecoded(outputFile, decoder.total);
+    } else {
+        ok = decompressStream(input, outputFile);
+    }
+    fclose(outputFile);
+    return ok;
 }
 
 /**
- * @brief Comprime todos los archivos de texto de un directorio en un solo archivo binario
+ * @brief Comprime todos los archivos de un directorio y sus subdirectorios en un
+ * solo archivo binario; cada miembro se guarda con su ruta relativa.
  * @param inputDir Directorio de entrada
  * @param outputFile Archivo binario de salida
  * @return true si la compresión fue exitosa, false en caso contrario
  */
 bool compressDirectory(const char* inputDir, const char* outputFile) {
-    DIR* dir;
-    struct dirent* entry;
     FILE* output;
     
-    // Abrir el directorio
-    dir = opendir(inputDir);
-    if (dir == NULL) {
-        perror("Error al abrir el directorio");
+    // Recorrer el árbol (en paralelo) y contar archivos regulares
+    int fileCount;
+    struct walkEntry* files = walkDirectory(inputDir, &fileCount);
+    if (files == NULL) {
         return false;
     }
     
-    // Crear el archivo de salida
-    output = fopen(outputFile, "wb");
+    // Crear el archivo de salida (también se lee, para el CRC32 de cada miembro)
+    output = fopen(outputFile, "wb+");
     if (output == NULL) {
         perror("Error al crear el archivo de salida");
-        closedir(dir);
+        freeWalkEntries(files, fileCount);
         return false;
     }
     
-    // Primera pasada: contar archivos regulares
-    int fileCount = 0;
-    while ((entry = readdir(dir)) != NULL) {
-        // Saltar . y ..
-        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
-            continue;
-        }
-        
-        // Construir ruta completa
-        char filepath[1024];
-        snprintf(filepath, sizeof(filepath), "%s/%s", inputDir, entry->d_name);
-        
-        // Verificar si es archivo regular
-        if (isRegularFile(filepath)) {
-            fileCount++;
-        }
-    }
-    
     printf("Archivos encontrados: %d\n", fileCount);
     
-    // Escribir el número de archivos al inicio
-    fwrite(&fileCount, sizeof(int), 1, output);
-    
-    // Reiniciar el directorio para segunda pasada
-    rewinddir(dir);
+    // Escribir la marca y la versión del contenedor
+    writeArchiveHeader(output);
+    struct archiveDirectory directory = { ARCHIVE_VERSION, 0, 0, NULL };
     
-    // Segunda pasada: comprimir cada archivo
+    // Comprimir cada archivo; en modo sólido los chicos se juntan en grupos
+    // (con el orden por ruta, los de una misma carpeta quedan juntos)
     int processedFiles = 0;
-    while ((entry = readdir(dir)) != NULL) {
-        // Saltar . y ..
-        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
-            continue;
+    bool ok = true;
+    struct walkEntry* group = solidGroups ? (struct walkEntry*)malloc(fileCount * sizeof(struct walkEntry)) : NULL;
+    int groupCount = 0;
+    long long groupBytes = 0;
+    for (int i = 0; i <= fileCount; i++) {
+        bool flush = groupCount > 0 && (i == fileCount || groupBytes >= HUFF_SOLID_GROUP_SIZE);
+        if (flush) {
+            printf("Comprimiendo grupo de %d archivos (%lld bytes)\n", groupCount, groupBytes);
+            int before = directory.count;
+            if (!compressArchiveGroup(output, &directory, group, groupCount)) {
+                ok = false;
+            }
+            processedFiles += directory.count - before;
+            groupCount = 0;
+            groupBytes = 0;
         }
-        
-        // Construir ruta completa
-        char filepath[1024];
-        snprintf(filepath, sizeof(filepath), "%s/%s", inputDir, entry->d_name);
-        
-        // Verificar si es archivo regular
-        if (!isRegularFile(filepath)) {
+        if (i == fileCount) break;
+        if (group != NULL && files[i].size <= HUFF_SOLID_MEMBER_MAX) {
+            group[groupCount++] = files[i];
+            groupBytes += files[i].size;
             continue;
         }
         
-        printf("Comprimiendo: %s\n", entry->d_name);
-        
-        // 1. Escribir longitud del nombre del archivo
-        int nameLength = strlen(entry->d_name);
-        fwrite(&nameLength, sizeof(int), 1, output);
-        
-        // 2. Escribir nombre del archivo
-        fwrite(entry->d_name, sizeof(char), nameLength, output);
-        
-        // 3. Comprimir el archivo a un archivo temporal
-        char tempCompressedFile[1024];
-        snprintf(tempCompressedFile, sizeof(tempCompressedFile), "/tmp/temp_compressed_%d.bin", processedFiles);
+        printf("Comprimiendo: %s\n", files[i].name);
         
-        compressFile(filepath, tempCompressedFile);
-        
-        // 4. Leer el archivo comprimido temporal y copiarlo al archivo final
-        FILE* tempFile = fopen(tempCompressedFile, "rb");
-        if (tempFile == NULL) {
-            fprintf(stderr, "Error al abrir archivo temporal: %s\n", tempCompressedFile);
+        // Comprimir directo al contenedor y registrarlo en el directorio central
+        if (!compressArchiveMember(output, &directory, files[i].name, files[i].path)) {
+            ok = false;
             continue;
         }
         
-        // Obtener tamaño del archivo comprimido
-        fseek(tempFile, 0, SEEK_END);
-        long long compressedSize = ftell(tempFile);
-        fseek(tempFile, 0, SEEK_SET);
-        
-        // 5. Escribir tamaño del archivo comprimido
-        fwrite(&compressedSize, sizeof(long long), 1, output);
-        
-        // 6. Copiar contenido del archivo comprimido
-        char buffer[4096];
-        size_t bytesRead;
-        while ((bytesRead = fread(buffer, 1, sizeof(buffer), tempFile)) > 0) {
-            fwrite(buffer, 1, bytesRead, output);
-        }
-        
-        fclose(tempFile);
-        
-        // Eliminar archivo temporal
-        remove(tempCompressedFile);
-        
         processedFiles++;
         printf("  Archivo %d/%d completado\n", processedFiles, fileCount);
     }
     
-    closedir(dir);
-    fclose(output);
+    // Directorio central al final: nombres, posiciones, tamaños y CRC32.
+    // Si faltó algún archivo (por ejemplo uno del grupo que no se pudo leer) el
+    // contenedor queda incompleto
+    if (directory.count != fileCount) ok = false;
+    if (!writeArchiveDirectory(output, &directory) || fflush(output) != 0) ok = false;
+    freeArchiveDirectory(&directory);
+    freeWalkEntries(files, fileCount);
+    free(group);
     
-    printf("\n¡Compresión de directorio completada!\n");
+    if (fclose(output) != 0) ok = false;
+    
+    printf("\n%s\n", ok ? "¡Compresión de directorio completada!" : "Compresión de directorio incompleta");
     printf("Archivos procesados: %d\n", processedFiles);
     printf("Archivo de salida: %s\n", outputFile);
     
-    return true;
+    return ok;
 }
 
 /**
@@ -861,31 +3926,17 @@ bool compressDirectory(const char* inputDir, const char* outputFile) {
  * @param inputDir Directorio a analizar
  */
 void listFilesToCompress(const char* inputDir) {
-    DIR* dir;
-    struct dirent* entry;
-    
-    dir = opendir(inputDir);
-    if (dir == NULL) {
-        perror("Error al abrir el directorio");
+    int fileCount;
+    struct walkEntry* files = walkDirectory(inputDir, &fileCount);
+    if (files == NULL) {
         return;
     }
     
     printf("=== Archivos a comprimir en %s ===\n", inputDir);
-    
-    while ((entry = readdir(dir)) != NULL) {
-        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
-            continue;
-        }
-        
-        char filepath[1024];
-        snprintf(filepath, sizeof(filepath), "%s/%s", inputDir, entry->d_name);
-        
-        if (isRegularFile(filepath)) {
-            printf("  - %s\n", entry->d_name);
-        }
+    for (int i = 0; i < fileCount; i++) {
+        printf("  - %s\n", files[i].name);
     }
-    
-    closedir(dir);
+    freeWalkEntries(files, fileCount);
     printf("===============================\n\n");
 }
 
@@ -925,7 +3976,6 @@ bool createDirectoryIfNotExists(const char* dirPath) {
  */
 bool decompressDirectory(const char* compressedFile, const char* outputDir) {
     FILE* input;
-    int fileCount;
     
     // Abrir el archivo comprimido
     input = fopen(compressedFile, "rb");
@@ -940,102 +3990,38 @@ bool decompressDirectory(const char* compressedFile, const char* outputDir) {
         return false;
     }
     
-    // Leer el número de archivos
-    if (fread(&fileCount, sizeof(int), 1, input) != 1) {
-        fprintf(stderr, "Error al leer el número de archivos\n");
+    // Leer el directorio central (o recorrer el formato viejo)
+    struct archiveDirectory directory;
+    if (!readArchiveDirectory(input, &directory)) {
+        freeArchiveDirectory(&directory);
         fclose(input);
         return false;
     }
+    int fileCount = directory.count;
     
     printf("Descomprimiendo %d archivos en: %s\n", fileCount, outputDir);
     
     // Procesar cada archivo
     for (int i = 0; i < fileCount; i++) {
-        // 1. Leer longitud del nombre del archivo
-        int nameLength;
-        if (fread(&nameLength, sizeof(int), 1, input) != 1) {
-            fprintf(stderr, "Error al leer la longitud del nombre del archivo %d\n", i + 1);
-            fclose(input);
-            return false;
-        }
-        
-        // Verificar que la longitud sea razonable
-        if (nameLength <= 0 || nameLength > 1000) {
-            fprintf(stderr, "Error: Longitud de nombre inválida: %d\n", nameLength);
-            fclose(input);
-            return false;
-        }
-        
-        // 2. Leer nombre del archivo
-        char fileName[1024];
-        if (fread(fileName, sizeof(char), nameLength, input) != nameLength) {
-            fprintf(stderr, "Error al leer el nombre del archivo %d\n", i + 1);
-            fclose(input);
-            return false;
-        }
-        fileName[nameLength] = '\0'; // Asegurar terminación de string
-        
-        // 3. Leer tamaño del archivo comprimido
-        long long compressedSize;
-        if (fread(&compressedSize, sizeof(long long), 1, input) != 1) {
-            fprintf(stderr, "Error al leer el tamaño comprimido del archivo: %s\n", fileName);
-            fclose(input);
-            return false;
-        }
-        
-        printf("Descomprimiendo archivo %d/%d: %s (%lld bytes comprimidos)\n", 
-               i + 1, fileCount, fileName, compressedSize);
-        
-        // 4. Crear archivo temporal con los datos comprimidos
-        char tempCompressedFile[1024];
-        snprintf(tempCompressedFile, sizeof(tempCompressedFile), "/tmp/temp_extract_%d.bin", i);
-        
-        FILE* tempFile = fopen(tempCompressedFile, "wb");
-        if (tempFile == NULL) {
-            fprintf(stderr, "Error al crear archivo temporal: %s\n", tempCompressedFile);
-            fclose(input);
-            return false;
-        }
-        
-        // 5. Copiar datos comprimidos al archivo temporal
-        char buffer[4096];
-        long long bytesRemaining = compressedSize;
-        
-        while (bytesRemaining > 0) {
-            size_t bytesToRead = (bytesRemaining < sizeof(buffer)) ? bytesRemaining : sizeof(buffer);
-            size_t bytesRead = fread(buffer, 1, bytesToRead, input);
-            
-            if (bytesRead == 0) {
-                fprintf(stderr, "Error al leer datos comprimidos del archivo: %s\n", fileName);
-                fclose(tempFile);
-                fclose(input);
-                remove(tempCompressedFile);
-                return false;
-            }
-            
-            fwrite(buffer, 1, bytesRead, tempFile);
-            bytesRemaining -= bytesRead;
-        }
-        
-        fclose(tempFile);
+        const struct archiveEntry* entry = &directory.entries[i];
+        // En los miembros agrupados el tamaño comprimido es una cantidad de bits
+        printf("Descomprimiendo archivo %d/%d: %s (%lld %s)\n", i + 1, fileCount, entry->name,
+               entry->compressedSize, (entry->group >= 0) ? "bits en un grupo sólido" : "bytes comprimidos");
         
-        // 6. Descomprimir el archivo temporal al directorio de salida
         char outputFilePath[1024];
-        snprintf(outputFilePath, sizeof(outputFilePath), "%s/%s", outputDir, fileName);
+        snprintf(outputFilePath, sizeof(outputFilePath), "%s/%s", outputDir, entry->name);
         
-        if (!decompressFile(tempCompressedFile, outputFilePath)) {
-            fprintf(stderr, "Error al descomprimir el archivo: %s\n", fileName);
-            remove(tempCompressedFile);
+        if (!extractArchiveMember(input, entry, outputFilePath)) {
+            fprintf(stderr, "Error al descomprimir el archivo: %s\n", entry->name);
+            freeArchiveDirectory(&directory);
             fclose(input);
             return false;
         }
         
-        // 7. Limpiar archivo temporal
-        remove(tempCompressedFile);
-        
-        printf("  ✓ %s descomprimido exitosamente\n", fileName);
+        printf("  ✓ %s descomprimido exitosamente\n", entry->name);
     }
     
+    freeArchiveDirectory(&directory);
     fclose(input);
     
     printf("\n¡Descompresión de directorio completada!\n");
@@ -1045,6 +4031,53 @@ bool decompressDirectory(const char* compressedFile, const char* outputDir) {
     return true;
 }
 
+/**
+ * @brief Extrae solo algunos miembros de un contenedor, buscándolos en el
+ * directorio central; no se lee nada del resto de los miembros.
+ * @param names Nombres de los miembros a extraer.
+ * @param nameCount Cantidad de nombres.
+ * @return true si se extrajeron todos los miembros pedidos.
+ */
+bool extractFilesFromArchive(const char* compressedFile, const char* outputDir, char** names, int nameCount) {
+    FILE* input = fopen(compressedFile, "rb");
+    if (input == NULL) {
+        perror("Error al abrir el archivo comprimido");
+        return false;
+    }
+    if (!createDirectoryIfNotExists(outputDir)) {
+        fclose(input);
+        return false;
+    }
+
+    struct archiveDirectory directory;
+    if (!readArchiveDirectory(input, &directory)) {
+        freeArchiveDirectory(&directory);
+        fclose(input);
+        return false;
+    }
+
+    bool ok = true;
+    for (int i = 0; i < nameCount; i++) {
+        const struct archiveEntry* entry = findArchiveEntry(&directory, names[i]);
+        if (entry == NULL) {
+            fprintf(stderr, "Error: '%s' no está en el archivo comprimido\n", names[i]);
+            ok = false;
+            continue;
+        }
+        char outputFilePath[1024];
+        snprintf(outputFilePath, sizeof(outputFilePath), "%s/%s", outputDir, entry->name);
+        if (extractArchiveMember(input, entry, outputFilePath)) {
+            printf("  ✓ %s extraído\n", entry->name);
+        } else {
+            ok = false;
+        }
+    }
+
+    freeArchiveDirectory(&directory);
+    fclose(input);
+    return ok;
+}
+
 /**
  * @brief Lista el contenido de un archivo de directorio comprimido (función auxiliar para debugging)
  * @param compressedFile Archivo comprimido a analizar
@@ -1056,45 +4089,37 @@ void listCompressedDirectoryContents(const char* compressedFile) {
         return;
     }
     
-    int fileCount;
-    if (fread(&fileCount, sizeof(int), 1, input) != 1) {
-        fprintf(stderr, "Error al leer el número de archivos\n");
+    struct archiveDirectory directory;
+    if (!readArchiveDirectory(input, &directory)) {
+        freeArchiveDirectory(&directory);
         fclose(input);
         return;
     }
     
     printf("=== Contenido del archivo comprimido: %s ===\n", compressedFile);
-    printf("Número de archivos: %d\n", fileCount);
+    printf("Número de archivos: %d\n", directory.count);
     
-    for (int i = 0; i < fileCount; i++) {
-        // Leer longitud del nombre
-        int nameLength;
-        if (fread(&nameLength, sizeof(int), 1, input) != 1) {
-            fprintf(stderr, "Error al leer longitud del nombre\n");
-            break;
-        }
-        
-        // Leer nombre
-        char fileName[1024];
-        if (fread(fileName, sizeof(char), nameLength, input) != nameLength) {
-            fprintf(stderr, "Error al leer nombre del archivo\n");
-            break;
-        }
-        fileName[nameLength] = '\0';
-        
-        // Leer tamaño comprimido
-        long long compressedSize;
-        if (fread(&compressedSize, sizeof(long long), 1, input) != 1) {
-            fprintf(stderr, "Error al leer tamaño comprimido\n");
-            break;
+    for (int i = 0; i < directory.count; i++) {
+        const struct archiveEntry* entry = &directory.entries[i];
+        unsigned char header[HUFF_MAGIC_SIZE + 1] = { 0 };
+        bool stored = entry->group < 0 &&
+                      pread(fileno(input), header, sizeof(header), entry->offset) == (ssize_t)sizeof(header) &&
+                      memcmp(header, HUFF_MAGIC, HUFF_MAGIC_SIZE) == 0 && header[HUFF_MAGIC_SIZE] == HUFF_MODE_STORED;
+        if (entry->group >= 0) {
+            printf("  %d. %s (%lld bytes originales, %lld bits en el grupo de la posición %lld, CRC32 %08x)\n",
+                   i + 1, entry->name, entry->originalSize, entry->compressedSize, entry->group, entry->checksum);
+        } else if (stored) {
+            printf("  %d. %s (%lld bytes originales, guardado sin comprimir, CRC32 %08x)\n", i + 1,
+                   entry->name, entry->originalSize, entry->checksum);
+        } else if (entry->originalSize >= 0) {
+            printf("  %d. %s (%lld bytes originales, %lld bytes comprimidos, CRC32 %08x)\n", i + 1,
+                   entry->name, entry->originalSize, entry->compressedSize, entry->checksum);
+        } else {
+            printf("  %d. %s (%lld bytes comprimidos)\n", i + 1, entry->name, entry->compressedSize);
         }
-        
-        printf("  %d. %s (%lld bytes comprimidos)\n", i + 1, fileName, compressedSize);
-        
-        // Saltar los datos comprimidos
-        fseek(input, compressedSize, SEEK_CUR);
     }
     
+    freeArchiveDirectory(&directory);
     fclose(input);
     printf("========================================\n\n");
 }
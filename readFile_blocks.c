@@ -0,0 +1,562 @@
+#define _DEFAULT_SOURCE  // Para open_memstream y pread/pwrite
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "tree.h"
+
+//--------------------------------------------------------------------------//
+//                                                                          //
+//        Contenedor por bloques: un archivo grande, varios hilos           //
+//                                                                          //
+//--------------------------------------------------------------------------//
+
+/**
+ * @brief Cantidad de hilos a usar: los núcleos disponibles.
+ */
+int getWorkerCount() {
+    long num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (num_threads <= 0) {
+        num_threads = 2; // Valor por defecto si falla la detección
+    }
+    return (int)num_threads;
+}
+
+// --- Conteo de frecuencias en paralelo ---
+typedef struct {
+    const unsigned char* data;
+    size_t size;
+    unsigned long long partial[256]; // Sub-histograma de este hilo
+} histogram_job_t;
+
+void* histogram_worker(void* arg) {
+    histogram_job_t* job = (histogram_job_t*)arg;
+    countFrequencies(job->data, job->size, job->partial);
+    return NULL;
+}
+
+/**
+ * @brief Cuenta frecuencias repartiendo el buffer entre los núcleos; cada hilo
+ * llena su propio sub-histograma y al final se suman. Los buffers menores a
+ * HUFF_PARALLEL_HISTOGRAM_MIN se cuentan en el hilo actual.
+ * @param frequencies Arreglo de 256 contadores, se le SUMAN los conteos.
+ */
+void countFrequenciesParallel(const unsigned char* data, size_t size, unsigned long long* frequencies) {
+    int num_threads = getWorkerCount();
+    if (size < HUFF_PARALLEL_HISTOGRAM_MIN || num_threads <= 1) {
+        countFrequencies(data, size, frequencies);
+        return;
+    }
+
+    histogram_job_t* jobs = calloc(num_threads, sizeof(histogram_job_t));
+    pthread_t threads[num_threads];
+    if (jobs == NULL) {
+        countFrequencies(data, size, frequencies);
+        return;
+    }
+
+    size_t slice = size / num_threads;
+    for (int i = 0; i < num_threads; i++) {
+        jobs[i].data = data + i * slice;
+        jobs[i].size = (i == num_threads - 1) ? size - i * slice : slice;
+        pthread_create(&threads[i], NULL, histogram_worker, &jobs[i]);
+    }
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+        for (int c = 0; c < 256; c++) {
+            frequencies[c] += jobs[i].partial[c];
+        }
+    }
+    free(jobs);
+}
+
+// --- Datos compartidos para comprimir por bloques ---
+typedef struct {
+    const unsigned char* data;
+    size_t size;
+    int block_count;
+    int window;              // Máximo de bloques comprimidos esperando a ser escritos
+    int next_block;          // Próximo bloque a tomar
+    int written_blocks;      // Bloques que ya escribió el hilo principal
+    unsigned char** results; // Bloque comprimido (miembro canónico completo)
+    size_t* result_sizes;
+    bool* ready;
+    bool failed;
+    pthread_mutex_t mutex;
+    pthread_cond_t block_ready;
+    pthread_cond_t window_moved;
+} block_compress_job_t;
+
+/**
+ * @brief Función que ejecuta cada hilo: toma bloques en orden y los comprime a memoria.
+ * No se adelanta más de 'window' bloques al escritor, así la memoria queda acotada.
+ */
+void* compress_block_worker(void* arg) {
+    block_compress_job_t* job = (block_compress_job_t*)arg;
+
+    while (true) {
+        pthread_mutex_lock(&job->mutex);
+        while (job->next_block < job->block_count &&
+               job->next_block >= job->written_blocks + job->window && !job->failed) {
+            pthread_cond_wait(&job->window_moved, &job->mutex);
+        }
+        if (job->next_block >= job->block_count || job->failed) {
+            pthread_mutex_unlock(&job->mutex);
+            break;
+        }
+        int block = job->next_block++;
+        pthread_mutex_unlock(&job->mutex);
+
+        size_t start = (size_t)block * HUFF_BLOCK_SIZE;
+        size_t length = (job->size - start < HUFF_BLOCK_SIZE) ? job->size - start : HUFF_BLOCK_SIZE;
+
+        // Cada bloque se escribe a memoria como un miembro canónico independiente
+        unsigned char* buffer;
+        size_t bufferSize;
+        bool ok = encodeMemberToMemory(job->data + start, length, &buffer, &bufferSize);
+
+        pthread_mutex_lock(&job->mutex);
+        if (!ok) {
+            job->failed = true;
+            pthread_cond_broadcast(&job->window_moved); // Despertar a los que esperan para salir
+        }
+        job->results[block] = buffer;
+        job->result_sizes[block] = bufferSize;
+        job->ready[block] = true;
+        pthread_cond_broadcast(&job->block_ready);
+        pthread_mutex_unlock(&job->mutex);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Cantidad de bloques de HUFF_BLOCK_SIZE en que se parte un miembro de size bytes.
+ */
+int blockCountFor(size_t size) {
+    return (int)((size + HUFF_BLOCK_SIZE - 1) / HUFF_BLOCK_SIZE);
+}
+
+/**
+ * @brief Escribe el encabezado del contenedor por bloques, con el índice en cero;
+ * después van los bloques en orden (writeContainerBlock) y finishBlockContainer.
+ * @return false si no hay memoria para el índice.
+ */
+bool beginBlockContainer(struct blockContainer* container, FILE* outputFile, size_t size) {
+    container->output = outputFile;
+    container->block_count = blockCountFor(size);
+    container->written = 0;
+    container->index = calloc(container->block_count > 0 ? container->block_count : 1, sizeof(long long));
+    if (container->index == NULL) {
+        perror("Fallo de memoria para el contenedor por bloques");
+        return false;
+    }
+    long long total_chars = (long long)size;
+    int block_size = HUFF_BLOCK_SIZE;
+    fwrite(HUFF_MAGIC, 1, HUFF_MAGIC_SIZE, outputFile);
+    fputc(HUFF_MODE_BLOCKS, outputFile);
+    fwrite(&total_chars, sizeof(long long), 1, outputFile);
+    fwrite(&block_size, sizeof(int), 1, outputFile);
+    fwrite(&container->block_count, sizeof(int), 1, outputFile);
+    container->index_offset = ftell(outputFile);
+    fwrite(container->index, sizeof(long long), container->block_count, outputFile);
+    return true;
+}
+
+// Agrega el próximo bloque (un miembro completo) y anota su tamaño en el índice
+void writeContainerBlock(struct blockContainer* container, const unsigned char* block, size_t bytes) {
+    if (block != NULL) {
+        fwrite(block, 1, bytes, container->output);
+    }
+    container->index[container->written++] = (long long)bytes;
+}
+
+/**
+ * @brief Completa el índice del contenedor y libera lo que usó.
+ * @param ok false si algún bloque falló (el índice no se completa).
+ * @return true si el contenedor quedó completo.
+ */
+bool finishBlockContainer(struct blockContainer* container, bool ok) {
+    long end_offset = ftell(container->output);
+    ok = ok && container->written == container->block_count &&
+         fseek(container->output, container->index_offset, SEEK_SET) == 0;
+    if (ok) {
+        fwrite(container->index, sizeof(long long), container->block_count, container->output);
+        fseek(container->output, end_offset, SEEK_SET);
+    }
+    free(container->index);
+    container->index = NULL;
+    return ok;
+}
+
+/**
+ * @brief Comprime un rango de memoria grande en el contenedor por bloques.
+ * Los hilos comprimen bloques de HUFF_BLOCK_SIZE en paralelo y el hilo
+ * principal los escribe en orden a medida que terminan.
+ * @param outputFile Debe permitir fseek: el índice se completa al final.
+ * @return true si la compresión fue exitosa.
+ */
+bool compressBlocks(const unsigned char* data, size_t size, FILE* outputFile) {
+    int block_count = blockCountFor(size);
+    int num_threads = getWorkerCount();
+    if (num_threads > block_count) num_threads = block_count;
+
+    block_compress_job_t job = {
+        .data = data,
+        .size = size,
+        .block_count = block_count,
+        .window = 2 * num_threads,
+        .next_block = 0,
+        .written_blocks = 0,
+        .results = calloc(block_count, sizeof(unsigned char*)),
+        .result_sizes = calloc(block_count, sizeof(size_t)),
+        .ready = calloc(block_count, sizeof(bool)),
+        .failed = false
+    };
+    if (job.results == NULL || job.result_sizes == NULL || job.ready == NULL) {
+        perror("Fallo de memoria para el contenedor por bloques");
+        free(job.results); free(job.result_sizes); free(job.ready);
+        return false;
+    }
+
+    // Encabezado, con espacio reservado para el índice
+    struct blockContainer container;
+    if (!beginBlockContainer(&container, outputFile, size)) {
+        free(job.results); free(job.result_sizes); free(job.ready);
+        return false;
+    }
+    pthread_mutex_init(&job.mutex, NULL);
+    pthread_cond_init(&job.block_ready, NULL);
+    pthread_cond_init(&job.window_moved, NULL);
+
+    pthread_t threads[num_threads];
+    for (int i = 0; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, compress_block_worker, &job);
+    }
+
+    // Escritor: saca los bloques en orden apenas están listos
+    for (int i = 0; i < block_count; i++) {
+        pthread_mutex_lock(&job.mutex);
+        // Si hubo un error, los bloques que nadie tomó nunca van a estar listos
+        while (!job.ready[i] && !(job.failed && i >= job.next_block)) {
+            pthread_cond_wait(&job.block_ready, &job.mutex);
+        }
+        if (!job.ready[i]) {
+            pthread_mutex_unlock(&job.mutex);
+            break;
+        }
+        unsigned char* block = job.results[i];
+        size_t block_bytes = job.result_sizes[i];
+        job.results[i] = NULL;
+        job.written_blocks = i + 1;
+        pthread_cond_broadcast(&job.window_moved);
+        pthread_mutex_unlock(&job.mutex);
+
+        writeContainerBlock(&container, block, block_bytes);
+        free(block);
+    }
+
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    for (int i = 0; i < block_count; i++) {
+        free(job.results[i]); // Solo quedan bloques si hubo un error
+    }
+
+    // Completar el índice
+    bool ok = finishBlockContainer(&container, !job.failed);
+
+    pthread_mutex_destroy(&job.mutex);
+    pthread_cond_destroy(&job.block_ready);
+    pthread_cond_destroy(&job.window_moved);
+    free(job.results);
+    free(job.result_sizes);
+    free(job.ready);
+    return ok;
+}
+
+/**
+ * @brief Posición desde la que los hilos escriben la salida: la actual (lo que ya
+ * había antes en el archivo se respeta), o -1 si hay que escribir en orden con un
+ * solo hilo, porque la salida es un pipe o tiene O_APPEND (ahí pwrite ignora la posición).
+ */
+static long long parallelOutputBase(int fd) {
+    int flags = fcntl(fd, F_GETFL);
+    struct stat st;
+    if (flags < 0 || (flags & O_APPEND) || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return -1;
+    }
+    return lseek(fd, 0, SEEK_CUR);
+}
+
+// Escribe un tramo decodificado: con pwrite en base + start, o a continuación si base es -1
+static bool writeDecodedRange(int fd, long long base, const unsigned char* data, size_t length, long long start) {
+    size_t written = 0;
+    while (written < length) {
+        ssize_t put = (base >= 0)
+            ? pwrite(fd, data + written, length - written, base + start + (long long)written)
+            : write(fd, data + written, length - written);
+        if (put <= 0) return false;
+        written += put;
+    }
+    return true;
+}
+
+// Deja el FILE* de salida después de lo que escribieron los hilos con pwrite
+static bool finishParallelOutput(FILE* outputFile, long long base, long long total) {
+    return base < 0 || fseek(outputFile, base + total, SEEK_SET) == 0;
+}
+
+// --- Datos compartidos para descomprimir por bloques ---
+typedef struct {
+    int input_fd;
+    int output_fd;
+    long long output_base;         // Dónde empieza la salida (-1 = escribir en orden)
+    long long total_chars;
+    int block_size;
+    int block_count;
+    const long long* offsets;      // Posición de cada bloque en el archivo comprimido
+    const long long* sizes;        // Tamaño comprimido de cada bloque
+    int next_block;
+    bool failed;
+    pthread_mutex_t mutex;
+} block_decompress_job_t;
+
+/**
+ * @brief Función que ejecuta cada hilo: lee un bloque con pread, lo decodifica
+ * y lo escribe con pwrite en su posición final del archivo de salida.
+ */
+void* decompress_block_worker(void* arg) {
+    block_decompress_job_t* job = (block_decompress_job_t*)arg;
+    unsigned char* out = malloc(job->block_size);
+    unsigned char* in = NULL;
+    size_t in_capacity = 0;
+    if (out == NULL) {
+        pthread_mutex_lock(&job->mutex);
+        job->failed = true;
+        pthread_mutex_unlock(&job->mutex);
+        return NULL;
+    }
+
+    while (true) {
+        pthread_mutex_lock(&job->mutex);
+        int block = job->next_block++;
+        bool stop = block >= job->block_count || job->failed;
+        pthread_mutex_unlock(&job->mutex);
+        if (stop) break;
+
+        size_t compressed = (size_t)job->sizes[block];
+        if (compressed > in_capacity) {
+            unsigned char* grown = realloc(in, compressed);
+            if (grown == NULL) {
+                pthread_mutex_lock(&job->mutex);
+                job->failed = true;
+                pthread_mutex_unlock(&job->mutex);
+                break;
+            }
+            in = grown;
+            in_capacity = compressed;
+        }
+
+        long long start = (long long)block * job->block_size;
+        size_t length = (job->total_chars - start < job->block_size) ? (size_t)(job->total_chars - start) : (size_t)job->block_size;
+
+        bool ok = pread(job->input_fd, in, compressed, job->offsets[block]) == (ssize_t)compressed &&
+                  decodeMemberFromMemory(in, compressed, out, length) &&
+                  writeDecodedRange(job->output_fd, job->output_base, out, length, start);
+        if (!ok) {
+            pthread_mutex_lock(&job->mutex);
+            job->failed = true;
+            pthread_mutex_unlock(&job->mutex);
+            break;
+        }
+    }
+
+    free(in);
+    free(out);
+    return NULL;
+}
+
+/**
+ * @brief Descomprime un contenedor por bloques usando un hilo por núcleo.
+ * @param compressedFile Posicionado justo después del byte de modo.
+ * @param outputFile Salida; los bloques van desde su posición actual (con pwrite
+ * si es un archivo regular sin O_APPEND, en orden si no).
+ * @return La cantidad de caracteres descomprimidos, o -1 si hubo un error.
+ */
+long long decompressBlocks(FILE* compressedFile, FILE* outputFile) {
+    long long total_chars;
+    int block_size, block_count;
+    if (fread(&total_chars, sizeof(long long), 1, compressedFile) != 1 ||
+        fread(&block_size, sizeof(int), 1, compressedFile) != 1 ||
+        fread(&block_count, sizeof(int), 1, compressedFile) != 1 ||
+        total_chars < 0 || block_size <= 0 || block_count < 0 ||
+        (long long)block_count != (total_chars + block_size - 1) / block_size) {
+        fprintf(stderr, "Error: encabezado de bloques inválido\n");
+        return -1;
+    }
+
+    long long* sizes = malloc((block_count > 0 ? block_count : 1) * sizeof(long long));
+    long long* offsets = malloc((block_count > 0 ? block_count : 1) * sizeof(long long));
+    if (sizes == NULL || offsets == NULL ||
+        fread(sizes, sizeof(long long), block_count, compressedFile) != (size_t)block_count) {
+        fprintf(stderr, "Error al leer el índice de bloques\n");
+        free(sizes); free(offsets);
+        return -1;
+    }
+
+    // El índice guarda tamaños; las posiciones salen de sumarlos
+    long long position = ftell(compressedFile);
+    for (int i = 0; i < block_count; i++) {
+        offsets[i] = position;
+        position += sizes[i];
+    }
+
+    fflush(outputFile);
+    block_decompress_job_t job = {
+        .input_fd = fileno(compressedFile),
+        .output_fd = fileno(outputFile),
+        .output_base = parallelOutputBase(fileno(outputFile)),
+        .total_chars = total_chars,
+        .block_size = block_size,
+        .block_count = block_count,
+        .offsets = offsets,
+        .sizes = sizes,
+        .next_block = 0,
+        .failed = false
+    };
+    pthread_mutex_init(&job.mutex, NULL);
+
+    // Sin posición fija, un solo hilo toma los bloques en orden
+    int num_threads = (job.output_base < 0) ? 1 : getWorkerCount();
+    if (num_threads > block_count) num_threads = block_count;
+    pthread_t threads[num_threads > 0 ? num_threads : 1];
+    for (int i = 0; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, decompress_block_worker, &job);
+    }
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&job.mutex);
+    free(sizes);
+    free(offsets);
+    if (!job.failed && !finishParallelOutput(outputFile, job.output_base, total_chars)) {
+        job.failed = true;
+    }
+    return job.failed ? -1 : total_chars;
+}
+
+//--------------------------------------------------------------------------//
+//                                                                          //
+//      Puntos de sincronización: un solo miembro, varios hilos             //
+//                                                                          //
+//--------------------------------------------------------------------------//
+
+// --- Datos compartidos para descomprimir por puntos de sincronización ---
+typedef struct {
+    int input_fd;
+    int output_fd;
+    long long output_base;          // Dónde empieza la salida (-1 = escribir en orden)
+    long long data_offset;          // Posición de los datos en el archivo comprimido
+    long long data_bytes;
+    const struct decodeTable* table;
+    long long total_chars;
+    int interval;
+    const long long* bit_offsets;   // Posición en bits de cada tramo
+    int point_count;
+    int next_point;                 // Se reparte con fetch-add atómico
+    bool failed;
+} sync_decompress_job_t;
+
+/**
+ * @brief Función que ejecuta cada hilo: lee el rango de bytes de un tramo con
+ * pread, lo decodifica desde su bit de inicio y lo escribe con pwrite.
+ */
+void* decompress_sync_worker(void* arg) {
+    sync_decompress_job_t* job = (sync_decompress_job_t*)arg;
+    unsigned char* out = malloc(job->interval);
+    unsigned char* in = NULL;
+    size_t in_capacity = 0;
+    bool ok = out != NULL;
+
+    while (ok && !__atomic_load_n(&job->failed, __ATOMIC_RELAXED)) {
+        int point = __atomic_fetch_add(&job->next_point, 1, __ATOMIC_RELAXED);
+        if (point >= job->point_count) break;
+
+        // Bytes que cubren el tramo: del byte del primer bit al del último
+        long long first_bit = job->bit_offsets[point];
+        long long start_byte = first_bit / 8;
+        long long end_byte = (point + 1 < job->point_count)
+            ? (job->bit_offsets[point + 1] + 7) / 8
+            : job->data_bytes;
+        size_t compressed = (size_t)(end_byte - start_byte);
+        if (compressed > in_capacity) {
+            unsigned char* grown = realloc(in, compressed > 0 ? compressed : 1);
+            if (grown == NULL) {
+                ok = false;
+                break;
+            }
+            in = grown;
+            in_capacity = compressed;
+        }
+
+        long long start = (long long)point * job->interval;
+        size_t length = (job->total_chars - start < job->interval) ? (size_t)(job->total_chars - start) : (size_t)job->interval;
+
+        ok = pread(job->input_fd, in, compressed, job->data_offset + start_byte) == (ssize_t)compressed &&
+             decodeSymbolsFromMemory(job->table, in, compressed, (int)(first_bit % 8), out, length) &&
+             writeDecodedRange(job->output_fd, job->output_base, out, length, start);
+    }
+
+    if (!ok) {
+        __atomic_store_n(&job->failed, true, __ATOMIC_RELAXED);
+    }
+    free(in);
+    free(out);
+    return NULL;
+}
+
+/**
+ * @brief Descomprime un miembro con puntos de sincronización repartiendo sus
+ * tramos entre un hilo por núcleo; todos comparten la misma tabla.
+ * @param inputFd Descriptor del archivo comprimido (se lee con pread).
+ * @param dataOffset Posición del primer byte de datos.
+ * @param outputFile Salida; los tramos van desde su posición actual (con pwrite
+ * si es un archivo regular sin O_APPEND, en orden si no).
+ * @return true si se decodificaron todos los tramos.
+ */
+bool decompressSyncPoints(int inputFd, long long dataOffset, long long dataBytes, const struct decodeTable* table,
+                          long long total, int interval, const long long* bitOffsets, int pointCount, FILE* outputFile) {
+    fflush(outputFile);
+    sync_decompress_job_t job = {
+        .input_fd = inputFd,
+        .output_fd = fileno(outputFile),
+        .output_base = parallelOutputBase(fileno(outputFile)),
+        .data_offset = dataOffset,
+        .data_bytes = dataBytes,
+        .table = table,
+        .total_chars = total,
+        .interval = interval,
+        .bit_offsets = bitOffsets,
+        .point_count = pointCount,
+        .next_point = 0,
+        .failed = false
+    };
+
+    // Sin posición fija, un solo hilo toma los tramos en orden
+    int num_threads = (job.output_base < 0) ? 1 : getWorkerCount();
+    if (num_threads > pointCount) num_threads = pointCount;
+    pthread_t threads[num_threads > 0 ? num_threads : 1];
+    for (int i = 0; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, decompress_sync_worker, &job);
+    }
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    return !job.failed && finishParallelOutput(outputFile, job.output_base, total);
+}
\ No newline at end of file
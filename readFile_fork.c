@@ -1,359 +1,661 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <stdbool.h>
-#include <string.h>
-#include <unistd.h>      // Para fork(), getpid()
-#include <sys/wait.h>    // Para wait(), waitpid()
-#include <sys/stat.h>    // Para mkdir, stat
-#include <dirent.h>      // Para opendir, readdir
-#include <time.h>        // Para medir tiempo
-#include "tree.h"
-
-//--------------------------------------------------------------------------//
-//                                                                          //
-//                    Funciones auxiliares para fork()                     //
-//                                                                          //
-//--------------------------------------------------------------------------//
-
-/**
- * @brief Mide tiempo en milisegundos
- * @return Tiempo actual en milisegundos
- */
-long long getCurrentTimeMs() {
-    return (long long)((double)clock() * 1000 / CLOCKS_PER_SEC);
-}
-
-/**
- * @brief Imprime información del proceso
- * @param message Mensaje a mostrar
- */
-void printProcessInfo(const char* message) {
-    printf("[PID %d] %s\n", getpid(), message);
-    fflush(stdout);
-}
-
-/**
- * @brief Cuenta archivos regulares en un directorio
- * @param inputDir Directorio a analizar
- * @return Número de archivos regulares
- */
-int countFilesInDirectory(const char* inputDir) {
-    DIR* dir = opendir(inputDir);
-    if (dir == NULL) {
-        return -1;
-    }
-    
-    struct dirent* entry;
-    int count = 0;
-    
-    while ((entry = readdir(dir)) != NULL) {
-        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
-            continue;
-        }
-        
-        char filepath[1024];
-        snprintf(filepath, sizeof(filepath), "%s/%s", inputDir, entry->d_name);
-        
-        if (isRegularFile(filepath)) {
-            count++;
-        }
-    }
-    
-    closedir(dir);
-    return count;
-}
-
-//--------------------------------------------------------------------------//
-//                                                                          //
-//              Compresión de directorio con fork()                        //
-//                                                                          //
-//--------------------------------------------------------------------------//
-
-/**
- * @brief Comprime todos los archivos de un directorio usando procesos paralelos con fork()
- * @param inputDir Directorio de entrada
- * @param outputFile Archivo binario de salida
- * @return true si la compresión fue exitosa, false en caso contrario
- */
-bool compressDirectoryFork(const char* inputDir, const char* outputFile) {
-    printProcessInfo("Iniciando compresión de directorio con fork()");
-    long long startTime = getCurrentTimeMs();
-    
-    DIR* dir;
-    struct dirent* entry;
-    FILE* output;
-    
-    // Abrir el directorio
-    dir = opendir(inputDir);
-    if (dir == NULL) {
-        perror("Error al abrir el directorio");
-        return false;
-    }
-    
-    // Contar archivos
-    int fileCount = countFilesInDirectory(inputDir);
-    if (fileCount <= 0) {
-        printf("No se encontraron archivos para comprimir\n");
-        closedir(dir);
-        return false;
-    }
-    
-    printf("Archivos encontrados: %d\n", fileCount);
-    
-    // Crear arrays para almacenar información de los archivos
-    char fileNames[fileCount][256];
-    char tempFiles[fileCount][1024];
-    pid_t childPids[fileCount];
-    int fileIndex = 0;
-    
-    // Primera pasada: recopilar nombres de archivos
-    rewinddir(dir);
-    while ((entry = readdir(dir)) != NULL && fileIndex < fileCount) {
-        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
-            continue;
-        }
-        
-        char filepath[1024];
-        snprintf(filepath, sizeof(filepath), "%s/%s", inputDir, entry->d_name);
-        
-        if (isRegularFile(filepath)) {
-            strcpy(fileNames[fileIndex], entry->d_name);
-            snprintf(tempFiles[fileIndex], sizeof(tempFiles[fileIndex]), 
-                    "/tmp/temp_compressed_fork_%d_%d.bin", getpid(), fileIndex);
-            fileIndex++;
-        }
-    }
-    closedir(dir);
-    
-    printf("Creando %d procesos hijos para compresión paralela...\n", fileCount);
-    
-    // Crear procesos hijos para comprimir archivos en paralelo
-    for (int i = 0; i < fileCount; i++) {
-        pid_t pid = fork();
-        
-        if (pid == 0) {
-            // PROCESO HIJO: comprimir un archivo específico
-            char inputFilePath[1024];
-            snprintf(inputFilePath, sizeof(inputFilePath), "%s/%s", inputDir, fileNames[i]);
-            
-            printProcessInfo("Comprimiendo archivo");
-            printf("[PID %d] Archivo: %s -> %s\n", getpid(), fileNames[i], tempFiles[i]);
-            
-            // Comprimir el archivo
-            compressFile(inputFilePath, tempFiles[i]);
-            
-            printProcessInfo("Compresión completada");
-            exit(0); // El hijo termina aquí
-            
-        } else if (pid > 0) {
-            // PROCESO PADRE: guardar PID del hijo
-            childPids[i] = pid;
-            printf("[PID %d] Creado proceso hijo [PID %d] para: %s\n", 
-                   getpid(), pid, fileNames[i]);
-            
-        } else {
-            // Error en fork()
-            perror("Error en fork()");
-            return false;
-        }
-    }
-    
-    // PROCESO PADRE: esperar a que todos los hijos terminen
-    printProcessInfo("Esperando a que terminen todos los procesos hijos...");
-    for (int i = 0; i < fileCount; i++) {
-        int status;
-        waitpid(childPids[i], &status, 0);
-        printf("[PID %d] Proceso hijo [PID %d] terminado (archivo: %s)\n", 
-               getpid(), childPids[i], fileNames[i]);
-    }
-    
-    // Crear el archivo final combinando todos los archivos temporales
-    printProcessInfo("Combinando archivos comprimidos...");
-    output = fopen(outputFile, "wb");
-    if (output == NULL) {
-        perror("Error al crear el archivo de salida");
-        return false;
-    }
-    
-    // Escribir número de archivos
-    fwrite(&fileCount, sizeof(int), 1, output);
-    
-    // Combinar todos los archivos temporales
-    for (int i = 0; i < fileCount; i++) {
-        int nameLength = strlen(fileNames[i]);
-        fwrite(&nameLength, sizeof(int), 1, output);
-        fwrite(fileNames[i], sizeof(char), nameLength, output);
-        
-        // Leer archivo temporal y obtener su tamaño
-        FILE* tempFile = fopen(tempFiles[i], "rb");
-        if (tempFile == NULL) {
-            fprintf(stderr, "Error al abrir archivo temporal: %s\n", tempFiles[i]);
-            continue;
-        }
-        
-        fseek(tempFile, 0, SEEK_END);
-        long long compressedSize = ftell(tempFile);
-        fseek(tempFile, 0, SEEK_SET);
-        
-        // Escribir tamaño y contenido
-        fwrite(&compressedSize, sizeof(long long), 1, output);
-        
-        char buffer[4096];
-        size_t bytesRead;
-        while ((bytesRead = fread(buffer, 1, sizeof(buffer), tempFile)) > 0) {
-            fwrite(buffer, 1, bytesRead, output);
-        }
-        
-        fclose(tempFile);
-        remove(tempFiles[i]);
-        
-        printf("Archivo combinado: %s (%lld bytes)\n", fileNames[i], compressedSize);
-    }
-    
-    fclose(output);
-    
-    long long endTime = getCurrentTimeMs();
-    long long totalTime = endTime - startTime;
-    
-    printf("\n=== COMPRESIÓN CON FORK() COMPLETADA ===\n");
-    printf("Archivos procesados: %d\n", fileCount);
-    printf("Tiempo total: %lld ms\n", totalTime);
-    printf("Archivo de salida: %s\n", outputFile);
-    
-    return true;
-}
-
-//--------------------------------------------------------------------------//
-//                                                                          //
-//              Descompresión de directorio con fork()                     //
-//                                                                          //
-//--------------------------------------------------------------------------//
-
-/**
- * @brief Descomprime un directorio usando procesos paralelos con fork()
- * @param compressedFile Archivo comprimido
- * @param outputDir Directorio de salida
- * @return true si fue exitoso, false en caso contrario
- */
-bool decompressDirectoryFork(const char* compressedFile, const char* outputDir) {
-    printProcessInfo("Iniciando descompresión de directorio con fork()");
-    long long startTime = getCurrentTimeMs();
-    
-    FILE* input = fopen(compressedFile, "rb");
-    if (input == NULL) {
-        perror("Error al abrir el archivo comprimido");
-        return false;
-    }
-    
-    // Crear directorio de salida
-    if (!createDirectoryIfNotExists(outputDir)) {
-        fclose(input);
-        return false;
-    }
-    
-    // Leer número de archivos
-    int fileCount;
-    if (fread(&fileCount, sizeof(int), 1, input) != 1) {
-        fprintf(stderr, "Error al leer el número de archivos\n");
-        fclose(input);
-        return false;
-    }
-    
-    printf("Descomprimiendo %d archivos con fork()...\n", fileCount);
-    
-    // Arrays para almacenar información
-    char fileNames[fileCount][256];
-    char tempCompressedFiles[fileCount][1024];
-    char outputFilePaths[fileCount][1024];
-    pid_t childPids[fileCount];
-    
-    // Extraer todos los archivos comprimidos a archivos temporales
-    for (int i = 0; i < fileCount; i++) {
-        int nameLength;
-        fread(&nameLength, sizeof(int), 1, input);
-        fread(fileNames[i], sizeof(char), nameLength, input);
-        fileNames[i][nameLength] = '\0';
-        
-        long long compressedSize;
-        fread(&compressedSize, sizeof(long long), 1, input);
-        
-        // Crear archivo temporal
-        snprintf(tempCompressedFiles[i], sizeof(tempCompressedFiles[i]), 
-                "/tmp/temp_extract_fork_%d_%d.bin", getpid(), i);
-        snprintf(outputFilePaths[i], sizeof(outputFilePaths[i]), 
-                "%s/%s", outputDir, fileNames[i]);
-        
-        FILE* tempFile = fopen(tempCompressedFiles[i], "wb");
-        if (tempFile == NULL) {
-            fprintf(stderr, "Error al crear archivo temporal para: %s\n", fileNames[i]);
-            continue;
-        }
-        
-        // Copiar datos comprimidos
-        char buffer[4096];
-        long long bytesRemaining = compressedSize;
-        while (bytesRemaining > 0) {
-            size_t bytesToRead = (bytesRemaining < sizeof(buffer)) ? bytesRemaining : sizeof(buffer);
-            size_t bytesRead = fread(buffer, 1, bytesToRead, input);
-            fwrite(buffer, 1, bytesRead, tempFile);
-            bytesRemaining -= bytesRead;
-        }
-        
-        fclose(tempFile);
-        printf("Extraído archivo temporal: %s\n", fileNames[i]);
-    }
-    
-    fclose(input);
-    
-    // Crear procesos hijos para descomprimir en paralelo
-    printf("Creando %d procesos hijos para descompresión paralela...\n", fileCount);
-    
-    for (int i = 0; i < fileCount; i++) {
-        pid_t pid = fork();
-        
-        if (pid == 0) {
-            // PROCESO HIJO: descomprimir un archivo específico
-            printProcessInfo("Descomprimiendo archivo");
-            printf("[PID %d] Archivo: %s -> %s\n", getpid(), fileNames[i], outputFilePaths[i]);
-            
-            if (decompressFile(tempCompressedFiles[i], outputFilePaths[i])) {
-                printProcessInfo("Descompresión completada");
-            } else {
-                printProcessInfo("Error en descompresión");
-            }
-            
-            // Limpiar archivo temporal
-            remove(tempCompressedFiles[i]);
-            exit(0);
-            
-        } else if (pid > 0) {
-            // PROCESO PADRE: guardar PID
-            childPids[i] = pid;
-            printf("[PID %d] Creado proceso hijo [PID %d] para: %s\n", 
-                   getpid(), pid, fileNames[i]);
-                   
-        } else {
-            perror("Error en fork()");
-            return false;
-        }
-    }
-    
-    // PROCESO PADRE: esperar a todos los hijos
-    printProcessInfo("Esperando a que terminen todos los procesos hijos...");
-    for (int i = 0; i < fileCount; i++) {
-        int status;
-        waitpid(childPids[i], &status, 0);
-        printf("[PID %d] Proceso hijo [PID %d] terminado (archivo: %s)\n", 
-               getpid(), childPids[i], fileNames[i]);
-    }
-    
-    long long endTime = getCurrentTimeMs();
-    long long totalTime = endTime - startTime;
-    
-    printf("\n=== DESCOMPRESIÓN CON FORK() COMPLETADA ===\n");
-    printf("Archivos procesados: %d\n", fileCount);
-    printf("Tiempo total: %lld ms\n", totalTime);
-    printf("Directorio de salida: %s\n", outputDir);
-    
-    return true;
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>      // Para fork(), getpid()
+#include <sys/wait.h>    // Para wait(), waitpid()
+#include <sys/stat.h>    // Para mkdir, stat
+#include <time.h>        // Para medir tiempo
+#include <sys/mman.h>    // Para mmap (memoria compartida)
+#include <poll.h>        // Para poll
+#include <pthread.h>     // Hilo receptor mientras se comprimen los archivos grandes
+#include <errno.h>
+#include "tree.h"
+
+//--------------------------------------------------------------------------//
+//                                                                          //
+//                    Funciones auxiliares para fork()                     //
+//                                                                          //
+//--------------------------------------------------------------------------//
+
+/**
+ * @brief Mide tiempo en milisegundos
+ * @return Tiempo actual en milisegundos
+ */
+long long getCurrentTimeMs() {
+    return (long long)((double)clock() * 1000 / CLOCKS_PER_SEC);
+}
+
+/**
+ * @brief Imprime información del proceso
+ * @param message Mensaje a mostrar
+ */
+void printProcessInfo(const char* message) {
+    printf("[PID %d] %s\n", getpid(), message);
+    fflush(stdout);
+}
+
+/**
+ * @brief Cuenta archivos regulares en un directorio y sus subdirectorios
+ * @param inputDir Directorio a analizar
+ * @return Número de archivos regulares, o -1 si no se puede recorrer
+ */
+int countFilesInDirectory(const char* inputDir) {
+    int count;
+    struct walkEntry* files = walkDirectory(inputDir, &count);
+    if (files == NULL) {
+        return -1;
+    }
+    freeWalkEntries(files, count);
+    return count;
+}
+
+/**
+ * @brief Escribe todo el buffer en un descriptor (pipe), reintentando escrituras parciales
+ * @return true si se escribió completo
+ */
+static bool writeAll(int fd, const void* buffer, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)buffer;
+    while (size > 0) {
+        ssize_t written = write(fd, bytes, size);
+        if (written <= 0) return false;
+        bytes += written;
+        size -= written;
+    }
+    return true;
+}
+
+/**
+ * @brief Lee exactamente size bytes de un descriptor (pipe)
+ * @return true si se leyó completo
+ */
+static bool readAll(int fd, void* buffer, size_t size) {
+    unsigned char* bytes = (unsigned char*)buffer;
+    while (size > 0) {
+        ssize_t bytesRead = read(fd, bytes, size);
+        if (bytesRead <= 0) return false;
+        bytes += bytesRead;
+        size -= bytesRead;
+    }
+    return true;
+}
+
+// Límite de procesos del pool; 0 = uno por núcleo
+static int forkProcessLimit = 0;
+
+/**
+ * @brief Fija la cantidad máxima de procesos hijos que se crean a la vez
+ * @param limit Cantidad de procesos; 0 o menos vuelve al valor por defecto (núcleos)
+ */
+void setForkProcessLimit(int limit) {
+    forkProcessLimit = (limit > 0) ? limit : 0;
+}
+
+/**
+ * @brief Cantidad de procesos del pool para una cantidad de tareas
+ */
+static int forkPoolSize(int taskCount) {
+    int processes = (forkProcessLimit > 0) ? forkProcessLimit : getWorkerCount();
+    if (processes > taskCount) processes = taskCount;
+    return processes;
+}
+
+// Cola de tareas en memoria compartida: los hijos se reparten los índices
+// con un fetch-add atómico, y cada uno deja ahí si su tarea salió bien.
+typedef struct {
+    int next_task;
+    int task_count;
+    unsigned char task_ok[];
+} fork_queue_t;
+
+static fork_queue_t* createForkQueue(int taskCount) {
+    size_t size = sizeof(fork_queue_t) + (taskCount > 0 ? taskCount : 1);
+    void* memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        perror("Error en mmap()");
+        return NULL;
+    }
+    fork_queue_t* queue = (fork_queue_t*)memory;
+    queue->next_task = 0;
+    queue->task_count = taskCount;
+    memset(queue->task_ok, 0, taskCount);
+    return queue;
+}
+
+static void destroyForkQueue(fork_queue_t* queue) {
+    munmap(queue, sizeof(fork_queue_t) + (queue->task_count > 0 ? queue->task_count : 1));
+}
+
+// Saca la próxima tarea de la cola; -1 si ya no quedan
+static int takeForkTask(fork_queue_t* queue) {
+    int task = __atomic_fetch_add(&queue->next_task, 1, __ATOMIC_RELAXED);
+    return (task < queue->task_count) ? task : -1;
+}
+
+//--------------------------------------------------------------------------//
+//                                                                          //
+//              Compresión de directorio con fork()                        //
+//                                                                          //
+//--------------------------------------------------------------------------//
+
+// Mensaje de un hijo al padre por su pipe, seguido de 'size' bytes del miembro
+typedef struct {
+    int index;
+    long long original_size;
+    long long size;     // -1 si la compresión falló
+} fork_result_header_t;
+
+/**
+ * @brief Lo que hace cada hijo del pool: toma archivos de la cola compartida,
+ * los comprime a memoria y manda cada resultado al padre por su pipe.
+ */
+static void compressForkWorker(fork_queue_t* queue, const struct walkEntry* files,
+                               const bool* largeFiles, int resultFd) {
+    printProcessInfo("Proceso del pool iniciado");
+    int task;
+    while ((task = takeForkTask(queue)) >= 0) {
+        if (largeFiles[task]) {
+            continue; // Los archivos grandes los comprime el padre por bloques
+        }
+        printf("[PID %d] Comprimiendo: %s\n", getpid(), files[task].name);
+        
+        unsigned char* data;
+        size_t size;
+        fork_result_header_t header = { task, 0, -1 };
+        if (compressFileToMemory(files[task].path, &data, &size, &header.original_size)) {
+            header.size = (long long)size;
+        } else {
+            size = 0;
+        }
+        bool sent = writeAll(resultFd, &header, sizeof(header)) && writeAll(resultFd, data, size);
+        free(data);
+        if (!sent) {
+            break; // El padre ya no lee
+        }
+    }
+    close(resultFd);
+}
+
+/**
+ * @brief Lee un resultado completo del pipe de un hijo.
+ * @param data Recibe los bytes del miembro (liberar con free); NULL si no llegaron.
+ * @return 1 si llegó, 0 si el hijo cerró el pipe, -1 si llegó roto
+ */
+static int readForkResult(int fd, int fileCount, fork_result_header_t* header, unsigned char** data) {
+    *data = NULL;
+    if (!readAll(fd, header, sizeof(*header))) {
+        return 0;
+    }
+    bool received = header->index >= 0 && header->index < fileCount && header->size >= 0 &&
+                    (*data = malloc(header->size > 0 ? header->size : 1)) != NULL &&
+                    readAll(fd, *data, (size_t)header->size);
+    if (!received) {
+        fprintf(stderr, "Error al recibir un archivo comprimido\n");
+        free(*data);
+        *data = NULL;
+        return -1;
+    }
+    return 1;
+}
+
+// Agrega al contenedor un miembro que llegó de un hijo
+static bool appendForkResult(FILE* output, struct archiveDirectory* directory, const struct walkEntry* files,
+                             const fork_result_header_t* header, const unsigned char* data) {
+    if (!appendArchiveMember(output, directory, files[header->index].name, data,
+                             (size_t)header->size, header->original_size)) {
+        return false;
+    }
+    printf("Archivo combinado: %s (%lld bytes)\n", files[header->index].name, header->size);
+    return true;
+}
+
+/**
+ * @brief Espera a que llegue algo por los pipes de los hijos y agrega al contenedor
+ * cada resultado listo. Los pipes que se cierran se marcan con fd -1 y se descuentan
+ * de openChannels.
+ * @return false si poll() falló
+ */
+static bool receiveForkResults(struct pollfd* channels, int started, int* openChannels,
+                               FILE* output, struct archiveDirectory* directory,
+                               const struct walkEntry* files, int fileCount, bool* ok) {
+    if (poll(channels, started, -1) < 0) {
+        if (errno == EINTR) return true;
+        perror("Error en poll()");
+        *ok = false;
+        return false;
+    }
+    for (int p = 0; p < started; p++) {
+        if (channels[p].fd < 0 || channels[p].revents == 0) continue;
+        
+        fork_result_header_t header;
+        unsigned char* data;
+        int got = readForkResult(channels[p].fd, fileCount, &header, &data);
+        if (got == 0) {
+            // Fin del pipe: ese hijo ya no tiene trabajo
+            close(channels[p].fd);
+            channels[p].fd = -1;
+            (*openChannels)--;
+        } else if (got < 0 || !appendForkResult(output, directory, files, &header, data)) {
+            *ok = false;
+        }
+        free(data);
+    }
+    return true;
+}
+
+// Un resultado que el receptor ya sacó del pipe y todavía no está en el contenedor
+typedef struct fork_result {
+    fork_result_header_t header;
+    unsigned char* data;
+    struct fork_result* next;
+} fork_result_t;
+
+// Hilo que vacía los pipes mientras el padre comprime un archivo grande (el
+// contenedor lo está escribiendo el padre, así que los resultados esperan en memoria)
+typedef struct {
+    struct pollfd* channels;    // Pipes de los hijos y, al final, el pipe para despertarlo
+    int started;
+    int open_channels;
+    int file_count;
+    bool ok;
+    pthread_mutex_t mutex;
+    fork_result_t* head;
+    fork_result_t** tail;
+} fork_receiver_t;
+
+static void* forkReceiverWorker(void* arg) {
+    fork_receiver_t* receiver = (fork_receiver_t*)arg;
+    while (receiver->open_channels > 0) {
+        if (poll(receiver->channels, receiver->started + 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            perror("Error en poll()");
+            receiver->ok = false;
+            break;
+        }
+        if (receiver->channels[receiver->started].revents != 0) {
+            break; // El padre terminó con los archivos grandes
+        }
+        for (int p = 0; p < receiver->started; p++) {
+            struct pollfd* channel = &receiver->channels[p];
+            if (channel->fd < 0 || channel->revents == 0) continue;
+            
+            fork_result_t* result = (fork_result_t*)malloc(sizeof(fork_result_t));
+            if (result == NULL) {
+                perror("Fallo de memoria para un resultado");
+                receiver->ok = false;
+                continue; // Se vuelve a intentar en la próxima vuelta
+            }
+            int got = readForkResult(channel->fd, receiver->file_count, &result->header, &result->data);
+            if (got <= 0) {
+                if (got == 0) {
+                    close(channel->fd);
+                    channel->fd = -1;
+                    receiver->open_channels--;
+                } else {
+                    receiver->ok = false;
+                }
+                free(result);
+                continue;
+            }
+            result->next = NULL;
+            pthread_mutex_lock(&receiver->mutex);
+            *receiver->tail = result;
+            receiver->tail = &result->next;
+            pthread_mutex_unlock(&receiver->mutex);
+        }
+    }
+    return NULL;
+}
+
+// Agrega al contenedor los resultados que juntó el receptor hasta ahora
+static bool appendReceivedResults(fork_receiver_t* receiver, FILE* output, struct archiveDirectory* directory,
+                                  const struct walkEntry* files) {
+    pthread_mutex_lock(&receiver->mutex);
+    fork_result_t* result = receiver->head;
+    receiver->head = NULL;
+    receiver->tail = &receiver->head;
+    pthread_mutex_unlock(&receiver->mutex);
+
+    bool ok = true;
+    while (result != NULL) {
+        fork_result_t* next = result->next;
+        if (!appendForkResult(output, directory, files, &result->header, result->data)) {
+            ok = false;
+        }
+        free(result->data);
+        free(result);
+        result = next;
+    }
+    return ok;
+}
+
+/**
+ * @brief Comprime los archivos grandes directo al contenedor (por bloques) mientras
+ * un hilo receptor sigue vaciando los pipes, así los hijos no se traban con el pipe
+ * lleno durante un miembro largo. Lo recibido se agrega después de cada archivo grande.
+ * @param openChannels Pipes abiertos; se actualiza con los que cerró el receptor.
+ */
+static bool compressLargeForkFiles(FILE* output, struct archiveDirectory* directory,
+                                   const struct walkEntry* files, const bool* largeFiles, int fileCount,
+                                   struct pollfd* channels, int started, int* openChannels) {
+    int wake[2] = { -1, -1 };
+    fork_receiver_t receiver = { channels, started, *openChannels, fileCount, true,
+                                 PTHREAD_MUTEX_INITIALIZER, NULL, NULL };
+    receiver.tail = &receiver.head;
+    pthread_t thread;
+    bool receiving = *openChannels > 0 && pipe(wake) == 0;
+    if (receiving) {
+        channels[started].fd = wake[0];
+        channels[started].events = POLLIN;
+        if (pthread_create(&thread, NULL, forkReceiverWorker, &receiver) != 0) {
+            // Sin receptor los hijos pueden trabarse, pero el resultado es el mismo
+            fprintf(stderr, "Aviso: no se pudo crear el hilo receptor\n");
+            receiving = false;
+        }
+    }
+
+    bool ok = true;
+    for (int i = 0; i < fileCount; i++) {
+        if (!largeFiles[i]) continue;
+        printf("[PID %d] Comprimiendo por bloques: %s\n", getpid(), files[i].name);
+        if (!compressArchiveMember(output, directory, files[i].name, files[i].path)) {
+            ok = false;
+        }
+        if (receiving && !appendReceivedResults(&receiver, output, directory, files)) {
+            ok = false;
+        }
+    }
+
+    if (receiving) {
+        if (write(wake[1], "", 1) != 1) {
+            perror("Error al despertar el hilo receptor");
+        }
+        pthread_join(thread, NULL);
+        if (!appendReceivedResults(&receiver, output, directory, files) || !receiver.ok) {
+            ok = false;
+        }
+        *openChannels = receiver.open_channels;
+    }
+    if (wake[0] >= 0) {
+        close(wake[0]);
+        close(wake[1]);
+    }
+    return ok;
+}
+
+/**
+ * @brief Comprime todos los archivos de un directorio (y sus subdirectorios) usando un pool acotado de
+ * procesos (uno por núcleo por defecto, ver setForkProcessLimit)
+ * @param inputDir Directorio de entrada
+ * @param outputFile Archivo binario de salida
+ * @return true si la compresión fue exitosa, false en caso contrario
+ */
+bool compressDirectoryFork(const char* inputDir, const char* outputFile) {
+    printProcessInfo("Iniciando compresión de directorio con fork()");
+    long long startTime = getCurrentTimeMs();
+    
+    // Listar archivos (recorrido recursivo en paralelo)
+    int fileCount;
+    struct walkEntry* files = walkDirectory(inputDir, &fileCount);
+    if (files == NULL || fileCount <= 0) {
+        printf("No se encontraron archivos para comprimir\n");
+        freeWalkEntries(files, fileCount);
+        return false;
+    }
+    printf("Archivos encontrados: %d\n", fileCount);
+    
+    bool* largeFiles = malloc(fileCount * sizeof(bool));
+    fork_queue_t* queue = createForkQueue(fileCount);
+    int processCount = forkPoolSize(fileCount);
+    pid_t* childPids = malloc(processCount * sizeof(pid_t));
+    struct pollfd* channels = malloc((processCount + 1) * sizeof(struct pollfd)); // +1: receptor
+    if (largeFiles == NULL || queue == NULL || childPids == NULL || channels == NULL) {
+        perror("Fallo de memoria para el pool de procesos");
+        if (queue != NULL) destroyForkQueue(queue);
+        free(largeFiles); free(childPids); free(channels);
+        freeWalkEntries(files, fileCount);
+        return false;
+    }
+    for (int i = 0; i < fileCount; i++) {
+        largeFiles[i] = files[i].size >= (long long)HUFF_BLOCK_THRESHOLD;
+    }
+    
+    printf("Creando %d procesos hijos para compresión paralela...\n", processCount);
+    fflush(stdout); // Que los hijos no hereden texto pendiente
+    
+    // Crear el pool: cada hijo devuelve sus resultados por un pipe propio
+    int started = 0;
+    for (int p = 0; p < processCount; p++) {
+        int channel[2];
+        if (pipe(channel) != 0) {
+            perror("Error en pipe()");
+            break;
+        }
+        pid_t pid = fork();
+        
+        if (pid == 0) {
+            // PROCESO HIJO: solo necesita su extremo de escritura
+            close(channel[0]);
+            for (int q = 0; q < started; q++) close(channels[q].fd);
+            compressForkWorker(queue, files, largeFiles, channel[1]);
+            // Liberar lo heredado del padre antes de terminar
+            destroyForkQueue(queue);
+            free(largeFiles);
+            free(childPids);
+            free(channels);
+            freeWalkEntries(files, fileCount);
+            exit(0); // El hijo termina aquí
+            
+        } else if (pid > 0) {
+            // PROCESO PADRE: guardar PID del hijo y el extremo de lectura
+            close(channel[1]);
+            childPids[started] = pid;
+            channels[started].fd = channel[0];
+            channels[started].events = POLLIN;
+            started++;
+            printf("[PID %d] Creado proceso hijo [PID %d]\n", getpid(), pid);
+            
+        } else {
+            // Error en fork(): seguir con los hijos que ya existen
+            perror("Error en fork()");
+            close(channel[0]);
+            close(channel[1]);
+            break;
+        }
+    }
+    
+    bool ok = started > 0;
+    FILE* output = ok ? fopen(outputFile, "wb+") : NULL;
+    if (output == NULL) {
+        if (ok) perror("Error al crear el archivo de salida");
+        ok = false;
+        // Cerrar los pipes hace que los hijos terminen
+        for (int p = 0; p < started; p++) close(channels[p].fd);
+        started = 0;
+    }
+    
+    // Marca del contenedor; el directorio central va al final
+    struct archiveDirectory directory = { ARCHIVE_VERSION, 0, 0, NULL };
+    int openChannels = started;
+    if (output != NULL) {
+        printProcessInfo("Combinando archivos comprimidos...");
+        writeArchiveHeader(output);
+        
+        // Los archivos grandes se comprimen aquí, directo al contenedor, mientras
+        // un hilo sigue recibiendo lo que mandan los hijos
+        if (!compressLargeForkFiles(output, &directory, files, largeFiles, fileCount,
+                                    channels, started, &openChannels)) {
+            ok = false;
+        }
+    }
+    
+    // Leer los resultados en el orden en que llegan, hasta que todos los pipes se cierren
+    while (openChannels > 0 &&
+           receiveForkResults(channels, started, &openChannels, output, &directory,
+                              files, fileCount, &ok)) {
+    }
+    
+    // PROCESO PADRE: esperar a que todos los hijos terminen
+    printProcessInfo("Esperando a que terminen todos los procesos hijos...");
+    for (int p = 0; p < started; p++) {
+        int status;
+        waitpid(childPids[p], &status, 0);
+        printf("[PID %d] Proceso hijo [PID %d] terminado\n", getpid(), childPids[p]);
+    }
+    
+    if (output != NULL) {
+        if (directory.count != fileCount) ok = false;
+        writeArchiveDirectory(output, &directory);
+        fclose(output);
+    }
+    freeArchiveDirectory(&directory);
+    destroyForkQueue(queue);
+    free(largeFiles);
+    free(childPids);
+    free(channels);
+    freeWalkEntries(files, fileCount);
+    
+    long long endTime = getCurrentTimeMs();
+    long long totalTime = endTime - startTime;
+    
+    printf("\n=== COMPRESIÓN CON FORK() COMPLETADA ===\n");
+    printf("Archivos procesados: %d\n", fileCount);
+    printf("Tiempo total: %lld ms\n", totalTime);
+    printf("Archivo de salida: %s\n", outputFile);
+    
+    return ok;
+}
+
+//--------------------------------------------------------------------------//
+//                                                                          //
+//              Descompresión de directorio con fork()                     //
+//                                                                          //
+//--------------------------------------------------------------------------//
+
+/**
+ * @brief Lo que hace cada hijo del pool: abre su propio descriptor del contenedor
+ * y descomprime miembros tomados de la cola compartida hasta vaciarla.
+ */
+static void decompressForkWorker(fork_queue_t* queue, const char* compressedFile, const char* outputDir,
+                                 const struct archiveDirectory* directory) {
+    printProcessInfo("Proceso del pool iniciado");
+    FILE* input = fopen(compressedFile, "rb");
+    if (input == NULL) {
+        perror("Error al abrir el archivo comprimido");
+        return;
+    }
+    int task;
+    while ((task = takeForkTask(queue)) >= 0) {
+        const struct archiveEntry* entry = &directory->entries[task];
+        char outputFilePath[1024];
+        snprintf(outputFilePath, sizeof(outputFilePath), "%s/%s", outputDir, entry->name);
+        printf("[PID %d] Archivo: %s -> %s\n", getpid(), entry->name, outputFilePath);
+        
+        queue->task_ok[task] = extractArchiveMember(input, entry, outputFilePath);
+    }
+    fclose(input);
+}
+
+/**
+ * @brief Descomprime un directorio usando un pool acotado de procesos
+ * @param compressedFile Archivo comprimido
+ * @param outputDir Directorio de salida
+ * @return true si fue exitoso, false en caso contrario
+ */
+bool decompressDirectoryFork(const char* compressedFile, const char* outputDir) {
+    printProcessInfo("Iniciando descompresión de directorio con fork()");
+    long long startTime = getCurrentTimeMs();
+    
+    FILE* input = fopen(compressedFile, "rb");
+    if (input == NULL) {
+        perror("Error al abrir el archivo comprimido");
+        return false;
+    }
+    
+    // Crear directorio de salida
+    if (!createDirectoryIfNotExists(outputDir)) {
+        fclose(input);
+        return false;
+    }
+    
+    // Leer el directorio central: cada hijo salta directo a sus miembros
+    struct archiveDirectory directory;
+    if (!readArchiveDirectory(input, &directory)) {
+        freeArchiveDirectory(&directory);
+        fclose(input);
+        return false;
+    }
+    fclose(input);
+    int fileCount = directory.count;
+    
+    printf("Descomprimiendo %d archivos con fork()...\n", fileCount);
+    
+    fork_queue_t* queue = createForkQueue(fileCount);
+    int processCount = forkPoolSize(fileCount);
+    pid_t* childPids = malloc((processCount > 0 ? processCount : 1) * sizeof(pid_t));
+    if (queue == NULL || childPids == NULL) {
+        perror("Fallo de memoria para el pool de procesos");
+        if (queue != NULL) destroyForkQueue(queue);
+        free(childPids);
+        freeArchiveDirectory(&directory);
+        return false;
+    }
+    
+    // Crear el pool de procesos hijos
+    printf("Creando %d procesos hijos para descompresión paralela...\n", processCount);
+    fflush(stdout); // Que los hijos no hereden texto pendiente
+    
+    int started = 0;
+    for (int p = 0; p < processCount; p++) {
+        pid_t pid = fork();
+        
+        if (pid == 0) {
+            // PROCESO HIJO: vaciar la cola junto con los demás
+            decompressForkWorker(queue, compressedFile, outputDir, &directory);
+            destroyForkQueue(queue);
+            free(childPids);
+            freeArchiveDirectory(&directory);
+            exit(0);
+            
+        } else if (pid > 0) {
+            // PROCESO PADRE: guardar PID
+            childPids[started++] = pid;
+            printf("[PID %d] Creado proceso hijo [PID %d]\n", getpid(), pid);
+                   
+        } else {
+            // Error en fork(): seguir con los hijos que ya existen
+            perror("Error en fork()");
+            break;
+        }
+    }
+    
+    // PROCESO PADRE: esperar a todos los hijos
+    printProcessInfo("Esperando a que terminen todos los procesos hijos...");
+    for (int p = 0; p < started; p++) {
+        int status;
+        waitpid(childPids[p], &status, 0);
+        printf("[PID %d] Proceso hijo [PID %d] terminado\n", getpid(), childPids[p]);
+    }
+    
+    // Cada hijo dejó el resultado de sus tareas en la memoria compartida
+    bool ok = started > 0 || fileCount == 0;
+    for (int i = 0; i < fileCount; i++) {
+        if (!queue->task_ok[i]) {
+            fprintf(stderr, "Error al descomprimir el archivo: %s\n", directory.entries[i].name);
+            ok = false;
+        }
+    }
+    destroyForkQueue(queue);
+    free(childPids);
+    freeArchiveDirectory(&directory);
+    
+    long long endTime = getCurrentTimeMs();
+    long long totalTime = endTime - startTime;
+    
+    printf("\n=== DESCOMPRESIÓN CON FORK() COMPLETADA ===\n");
+    printf("Archivos procesados: %d\n", fileCount);
+    printf("Tiempo total: %lld ms\n", totalTime);
+    printf("Directorio de salida: %s\n", outputDir);
+    
+    return ok;
 }
\ No newline at end of file
@@ -0,0 +1,207 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "tree.h"
+
+//--------------------------------------------------------------------------//
+//                                                                          //
+//           LZ77: búsqueda de coincidencias con cadenas de hash            //
+//                                                                          //
+//--------------------------------------------------------------------------//
+
+#define LZ_HASH_BITS 16
+#define LZ_WINDOW_MASK (HUFF_LZ_WINDOW - 1)
+
+// Parámetros de cada nivel: cuántos candidatos revisar, desde qué largo
+// dejar de buscar, y si se prueba la posición siguiente antes de aceptar (lazy)
+struct lzLevel {
+    int chainDepth;
+    int niceLength;
+    bool lazy;
+};
+
+static const struct lzLevel lzLevels[HUFF_LZ_MAX_LEVEL + 1] = {
+    { 0, 0, false },         // 0: sin LZ77
+    { 4, 16, false },
+    { 8, 32, false },
+    { 16, 64, false },
+    { 32, 128, true },
+    { 64, 258, true },
+    { 128, 1024, true },
+    { 512, 4096, true },
+    { 2048, 16384, true },
+    { 8192, HUFF_LZ_MAX_MATCH, true },
+};
+
+static inline unsigned int lzHash(const unsigned char* p) {
+    unsigned int value;
+    memcpy(&value, p, sizeof(value));
+    return (value * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+// Estado del buscador: head[hash] = última posición con ese hash, prev = la anterior
+struct lzMatcher {
+    const unsigned char* data;
+    size_t size;
+    int* head;
+    int* prev;
+    const struct lzLevel* level;
+};
+
+static inline void lzInsert(struct lzMatcher* matcher, size_t position) {
+    if (position + HUFF_LZ_MIN_MATCH > matcher->size) return;
+    unsigned int hash = lzHash(matcher->data + position);
+    matcher->prev[position & LZ_WINDOW_MASK] = matcher->head[hash];
+    matcher->head[hash] = (int)position;
+}
+
+// Mejor coincidencia para position entre las posiciones ya insertadas
+static size_t lzLongestMatch(const struct lzMatcher* matcher, size_t position, size_t* distance) {
+    if (position + HUFF_LZ_MIN_MATCH > matcher->size) return 0;
+    const unsigned char* data = matcher->data;
+    size_t limit = matcher->size - position;
+    if (limit > HUFF_LZ_MAX_MATCH) limit = HUFF_LZ_MAX_MATCH;
+
+    size_t best = 0;
+    int candidate = matcher->head[lzHash(data + position)];
+    int chain = matcher->level->chainDepth;
+    while (candidate >= 0 && chain-- > 0 && position - (size_t)candidate < HUFF_LZ_WINDOW) {
+        // Primero el byte que haría más larga la coincidencia: descarta rápido
+        if (data[candidate + best] == data[position + best]) {
+            size_t length = 0;
+            while (length < limit && data[candidate + length] == data[position + length]) length++;
+            if (length > best) {
+                best = length;
+                *distance = position - (size_t)candidate;
+                if (length >= (size_t)matcher->level->niceLength || length == limit) break;
+            }
+        }
+        int next = matcher->prev[candidate & LZ_WINDOW_MASK];
+        if (next >= candidate) break; // La ventana ya pisó esa entrada
+        candidate = next;
+    }
+    return (best >= HUFF_LZ_MIN_MATCH) ? best : 0;
+}
+
+static bool addSequence(struct lzSequence** sequences, size_t* count, size_t* capacity,
+                        size_t literals, size_t matchLength, size_t distance) {
+    if (*count == *capacity) {
+        size_t grown = (*capacity == 0) ? 1024 : *capacity * 2;
+        struct lzSequence* larger = (struct lzSequence*)realloc(*sequences, grown * sizeof(struct lzSequence));
+        if (larger == NULL) return false;
+        *sequences = larger;
+        *capacity = grown;
+    }
+    struct lzSequence* sequence = &(*sequences)[(*count)++];
+    sequence->literals = (unsigned int)literals;
+    sequence->matchLength = (unsigned int)matchLength;
+    sequence->distance = (unsigned int)distance;
+    return true;
+}
+
+/**
+ * @brief Parte los datos en secuencias (literales, coincidencia) con LZ77.
+ * Cada secuencia son 'literals' bytes copiados tal cual seguidos de una copia de
+ * 'matchLength' bytes desde 'distance' bytes atrás. La última puede tener
+ * matchLength 0 (solo los literales del final).
+ * @param level De 1 (rápido) a HUFF_LZ_MAX_LEVEL (más chico).
+ * @param sequences Recibe un arreglo nuevo (malloc) con las secuencias.
+ * @return false si falta memoria o el nivel es inválido.
+ */
+bool lzFindSequences(const unsigned char* data, size_t size, int level,
+                     struct lzSequence** sequences, size_t* count) {
+    *sequences = NULL;
+    *count = 0;
+    if (level < 1 || level > HUFF_LZ_MAX_LEVEL || size > (size_t)0x7FFFFFFF) {
+        return false;
+    }
+    struct lzMatcher matcher = { data, size, NULL, NULL, &lzLevels[level] };
+    matcher.head = (int*)malloc((1 << LZ_HASH_BITS) * sizeof(int));
+    matcher.prev = (int*)malloc(HUFF_LZ_WINDOW * sizeof(int));
+    if (matcher.head == NULL || matcher.prev == NULL) {
+        free(matcher.head);
+        free(matcher.prev);
+        return false;
+    }
+    memset(matcher.head, -1, (1 << LZ_HASH_BITS) * sizeof(int));
+
+    size_t capacity = 0;
+    size_t literalStart = 0;
+    size_t position = 0;
+    bool ok = true;
+    while (ok && position < size) {
+        size_t distance = 0;
+        size_t length = lzLongestMatch(&matcher, position, &distance);
+        lzInsert(&matcher, position);
+
+        // Lazy: si en la posición siguiente hay algo más largo, esta va como literal
+        if (length > 0 && matcher.level->lazy && length < (size_t)matcher.level->niceLength) {
+            size_t nextDistance = 0;
+            size_t nextLength = lzLongestMatch(&matcher, position + 1, &nextDistance);
+            if (nextLength > length) {
+                position++;
+                continue;
+            }
+        }
+
+        if (length == 0) {
+            position++;
+            continue;
+        }
+        ok = addSequence(sequences, count, &capacity, position - literalStart, length, distance);
+        for (size_t k = 1; k < length; k++) {
+            lzInsert(&matcher, position + k);
+        }
+        position += length;
+        literalStart = position;
+    }
+    if (ok && literalStart < size) {
+        ok = addSequence(sequences, count, &capacity, size - literalStart, 0, 0);
+    }
+
+    free(matcher.head);
+    free(matcher.prev);
+    if (!ok) {
+        free(*sequences);
+        *sequences = NULL;
+        *count = 0;
+    }
+    return ok;
+}
+
+/**
+ * @brief Código de un valor (largo o distancia): los valores menores que 16 son su
+ * propio código; los demás se agrupan por su bit más alto y el siguiente, y el
+ * resto va en bits extra (como las longitudes y distancias de deflate).
+ * @param extraBits Recibe cuántos bits extra lleva el código.
+ */
+unsigned char lzValueCode(unsigned int value, int* extraBits) {
+    if (value < 16) {
+        *extraBits = 0;
+        return (unsigned char)value;
+    }
+    int top = 31 - __builtin_clz(value); // >= 4
+    *extraBits = top - 1;
+    return (unsigned char)(16 + (top - 4) * 2 + ((value >> (top - 1)) & 1));
+}
+
+/**
+ * @brief Inverso de lzValueCode: el valor más chico del código.
+ * @return false si el código no existe.
+ */
+bool lzValueBase(unsigned char code, unsigned int* base, int* extraBits) {
+    if (code < 16) {
+        *base = code;
+        *extraBits = 0;
+        return true;
+    }
+    int top = (code - 16) / 2 + 4;
+    if (top > 31) {
+        return false;
+    }
+    *extraBits = top - 1;
+    *base = (1u << top) | ((unsigned int)((code - 16) & 1) << (top - 1));
+    return true;
+}
@@ -1,307 +1,521 @@
-#define _DEFAULT_SOURCE  // ¿? Cosa rara de stack overflow para solucionar un problema de una variable
-#include <stdio.h>
-#include <stdlib.h>
-#include <stdbool.h>
-#include <string.h>
-#include <pthread.h>     
-#include <unistd.h>      
-#include <dirent.h>     
-#include <sys/stat.h> 
-
-#include "tree.h"
-
-// --- Datos para los Hilos ---
-typedef struct {
-    int thread_id;
-    char** file_list;
-    char** temp_file_list;
-    int total_files;
-    pthread_mutex_t* mutex;
-    int* next_file_index;
-} thread_data_t;
-
-// --- Esto hace cada thread ---
-/**
- * @brief Función que ejecuta cada hilo para comprimir archivos.
- */
-void* compress_worker(void* arg) {
-    thread_data_t* data = (thread_data_t*)arg;
-
-    while (true) {
-        int current_file_index;
-
-        // Sección crítica: obtener el índice del próximo archivo a procesar
-        pthread_mutex_lock(data->mutex);
-        current_file_index = *(data->next_file_index);
-        if (current_file_index >= data->total_files) {
-            pthread_mutex_unlock(data->mutex);
-            break; // No hay más archivos, el hilo termina
-        }
-        (*(data->next_file_index))++;
-        pthread_mutex_unlock(data->mutex);
-
-        // Obtener las rutas de los archivos
-        const char* input_path = data->file_list[current_file_index];
-        const char* temp_output_path = data->temp_file_list[current_file_index];
-
-        printf("[Hilo %d] Comprimiendo: %s -> %s\n", data->thread_id, input_path, temp_output_path);
-
-        // Llamar a la función de compresión segura para hilos
-        compressFile(input_path, temp_output_path);
-    }
-
-    return NULL;
-}
-
-
-// --- Función Principal de Compresión con Pthreads ---
-
-/**
- * @brief Comprime un directorio usando un pool de hilos (pthreads).
- * @param inputDir Directorio de entrada.
- * @param outputFile Archivo binario de salida.
- * @return true si la compresión fue exitosa, false en caso contrario.
- */
-bool compressDirectoryPthread(const char* inputDir, const char* outputFile) {
-    // 1. Obtener el número de núcleos de CPU para definir el número de hilos
-    long num_threads = sysconf(_SC_NPROCESSORS_ONLN);
-    if (num_threads <= 0) {
-        num_threads = 2; // Valor por defecto si falla la detección
-    }
-    printf("Iniciando compresión con %ld hilos...\n", num_threads);
-
-    // 2. Escanear directorio y listar archivos a comprimir
-    DIR* dir = opendir(inputDir);
-    if (dir == NULL) {
-        perror("Error al abrir directorio");
-        return false;
-    }
-
-    int file_count = 0;
-    struct dirent* entry;
-    // Contar archivos primero para asignar memoria
-    while ((entry = readdir(dir)) != NULL) {
-        if (entry->d_type == DT_REG) { // Si es un archivo regular
-            file_count++;
-        }
-    }
-    rewinddir(dir);
-
-    if (file_count == 0) {
-        printf("No se encontraron archivos en el directorio.\n");
-        closedir(dir);
-        return false;
-    }
-
-    // Asignar memoria para las listas de archivos
-    char** file_list = malloc(file_count * sizeof(char*));
-    char** temp_file_list = malloc(file_count * sizeof(char*));
-    char** original_filenames = malloc(file_count * sizeof(char*));
-
-    int index = 0;
-    while ((entry = readdir(dir)) != NULL && index < file_count) {
-        if (entry->d_type == DT_REG) {
-            char full_path[1024];
-            char temp_path[1024];
-            snprintf(full_path, sizeof(full_path), "%s/%s", inputDir, entry->d_name);
-            snprintf(temp_path, sizeof(temp_path), "/tmp/huffman_temp_%d_%d.bin", getpid(), index);
-
-            file_list[index] = strdup(full_path);
-            temp_file_list[index] = strdup(temp_path);
-            original_filenames[index] = strdup(entry->d_name);
-            index++;
-        }
-    }
-    closedir(dir);
-
-    // 3. Inicializar hilos y estructuras de sincronización
-    pthread_t threads[num_threads];
-    thread_data_t thread_data[num_threads];
-    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
-    int next_file_index = 0;
-
-    // 4. Lanzar el pool de hilos
-    for (long i = 0; i < num_threads; i++) {
-        thread_data[i].thread_id = i;
-        thread_data[i].file_list = file_list;
-        thread_data[i].temp_file_list = temp_file_list;
-        thread_data[i].total_files = file_count;
-        thread_data[i].mutex = &mutex;
-        thread_data[i].next_file_index = &next_file_index;
-        pthread_create(&threads[i], NULL, compress_worker, &thread_data[i]);
-    }
-
-    // 5. Esperar a que todos los hilos terminen
-    for (long i = 0; i < num_threads; i++) {
-        pthread_join(threads[i], NULL);
-    }
-
-    // 6. Combinar los archivos temporales en el archivo final
-    printf("Combinando %d archivos comprimidos...\n", file_count);
-    FILE* final_output = fopen(outputFile, "wb");
-    fwrite(&file_count, sizeof(int), 1, final_output);
-
-    for (int i = 0; i < file_count; i++) {
-        FILE* temp_file = fopen(temp_file_list[i], "rb");
-        if (temp_file) {
-            // Escribir metadatos
-            int name_len = strlen(original_filenames[i]);
-            fwrite(&name_len, sizeof(int), 1, final_output);
-            fwrite(original_filenames[i], sizeof(char), name_len, final_output);
-
-            // Escribir tamaño y contenido del archivo comprimido
-            fseek(temp_file, 0, SEEK_END);
-            long long compressed_size = ftell(temp_file);
-            rewind(temp_file);
-            fwrite(&compressed_size, sizeof(long long), 1, final_output);
-
-            char buffer[4096];
-            size_t bytes_read;
-            while ((bytes_read = fread(buffer, 1, sizeof(buffer), temp_file)) > 0) {
-                fwrite(buffer, 1, bytes_read, final_output);
-            }
-            fclose(temp_file);
-            remove(temp_file_list[i]); // Borrar archivo temporal
-        }
-    }
-    fclose(final_output);
-
-    // 7. Limpieza de memoria
-    for (int i = 0; i < file_count; i++) {
-        free(file_list[i]);
-        free(temp_file_list[i]);
-        free(original_filenames[i]);
-    }
-    free(file_list);
-    free(temp_file_list);
-    free(original_filenames);
-    pthread_mutex_destroy(&mutex);
-
-    printf("¡Compresión con Pthreads completada!\n");
-    return true;
-}
-
-// --- AÑADE ESTO AL FINAL DE readFile_pthread.c ---
-
-/**
- * @brief Función que ejecuta cada hilo para descomprimir archivos.
- */
-void* decompress_worker(void* arg) {
-    thread_data_t* data = (thread_data_t*)arg;
-
-    while (true) {
-        int current_file_index;
-
-        // Sección crítica para obtener el próximo trabajo
-        pthread_mutex_lock(data->mutex);
-        current_file_index = *(data->next_file_index);
-        if (current_file_index >= data->total_files) {
-            pthread_mutex_unlock(data->mutex);
-            break; // No hay más trabajo
-        }
-        (*(data->next_file_index))++;
-        pthread_mutex_unlock(data->mutex);
-
-        const char* temp_input_path = data->temp_file_list[current_file_index];
-        const char* final_output_path = data->file_list[current_file_index];
-
-        printf("[Hilo %d] Descomprimiendo: %s -> %s\n", data->thread_id, temp_input_path, final_output_path);
-
-        // La función de descompresión de un solo archivo ya es segura
-        decompressFile(temp_input_path, final_output_path);
-
-        // Borrar el archivo temporal
-        remove(temp_input_path);
-    }
-    return NULL;
-}
-
-/**
- * @brief Descomprime un directorio usando un pool de hilos (pthreads).
- * @param compressedFile Archivo .bin a descomprimir.
- * @param outputDir Directorio de salida.
- * @return true si la descompresión fue exitosa, false en caso contrario.
- */
-bool decompressDirectoryPthread(const char* compressedFile, const char* outputDir) {
-    long num_threads = sysconf(_SC_NPROCESSORS_ONLN);
-    if (num_threads <= 0) num_threads = 2;
-    printf("Iniciando descompresión con %ld hilos...\n", num_threads);
-
-    FILE* input = fopen(compressedFile, "rb");
-    if (!input) {
-        perror("Error al abrir archivo comprimido");
-        return false;
-    }
-    createDirectoryIfNotExists(outputDir);
-
-    int file_count;
-    fread(&file_count, sizeof(int), 1, input);
-
-    char** temp_file_list = malloc(file_count * sizeof(char*));
-    char** final_file_list = malloc(file_count * sizeof(char*));
-
-    // 1. Extraer los datos de cada archivo a un temporal
-    for (int i = 0; i < file_count; i++) {
-        int name_len;
-        fread(&name_len, sizeof(int), 1, input);
-        char filename[256];
-        fread(filename, sizeof(char), name_len, input);
-        filename[name_len] = '\0';
-
-        long long compressed_size;
-        fread(&compressed_size, sizeof(long long), 1, input);
-        
-        char temp_path[1024], final_path[1024];
-        snprintf(temp_path, sizeof(temp_path), "/tmp/huffman_decomp_temp_%d_%d.bin", getpid(), i);
-        snprintf(final_path, sizeof(final_path), "%s/%s", outputDir, filename);
-
-        temp_file_list[i] = strdup(temp_path);
-        final_file_list[i] = strdup(final_path);
-
-        FILE* temp_file = fopen(temp_path, "wb");
-        char buffer[4096];
-        long long bytes_remaining = compressed_size;
-        while(bytes_remaining > 0){
-            size_t bytes_to_read = (bytes_remaining < sizeof(buffer)) ? bytes_remaining : sizeof(buffer);
-            size_t bytes_read = fread(buffer, 1, bytes_to_read, input);
-            fwrite(buffer, 1, bytes_read, temp_file);
-            bytes_remaining -= bytes_read;
-        }
-        fclose(temp_file);
-    }
-    fclose(input);
-
-    // 2. Lanzar hilos para descomprimir los archivos temporales
-    pthread_t threads[num_threads];
-    thread_data_t thread_data[num_threads];
-    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
-    int next_file_index = 0;
-
-    for (long i = 0; i < num_threads; i++) {
-        thread_data[i] = (thread_data_t){
-            .thread_id = i,
-            .file_list = final_file_list,
-            .temp_file_list = temp_file_list,
-            .total_files = file_count,
-            .mutex = &mutex,
-            .next_file_index = &next_file_index
-        };
-        pthread_create(&threads[i], NULL, decompress_worker, &thread_data[i]);
-    }
-
-    // 3. Esperar y limpiar
-    for (long i = 0; i < num_threads; i++) {
-        pthread_join(threads[i], NULL);
-    }
-
-    for (int i = 0; i < file_count; i++) {
-        free(temp_file_list[i]);
-        free(final_file_list[i]);
-    }
-    free(temp_file_list);
-    free(final_file_list);
-    pthread_mutex_destroy(&mutex);
-
-    printf("¡Descompresión con Pthreads completada!\n");
-    return true;
+#define _DEFAULT_SOURCE  // ¿? Cosa rara de stack overflow para solucionar un problema de una variable
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>     
+#include <unistd.h>      
+#include <dirent.h>     
+#include <sys/stat.h> 
+
+#include "tree.h"
+
+// --- Un archivo dentro del pipeline de compresión ---
+typedef struct {
+    struct inputView view;      // Cargada por el lector
+    bool readable;
+    long long original_size;
+    bool large;                 // Pasa el umbral de bloques (según el recorrido)
+    bool split;                 // Sus bloques son tareas del pool; si es grande y no, lo comprime el escritor
+    int first_task;             // Sus tareas: [first_task, first_task + task_count)
+    int task_count;
+} pipeline_item_t;
+
+// --- Una tarea del pool: un archivo chico entero o un bloque de uno grande ---
+typedef struct {
+    int item;
+    int block;
+    unsigned char* data;        // Resultado del codificador
+    size_t size;
+    bool done;
+    bool ok;
+} pipeline_task_t;
+
+// --- Estado compartido del pipeline lector -> codificadores -> escritor ---
+typedef struct {
+    char** file_list;
+    pipeline_item_t* items;
+    pipeline_task_t* tasks;
+    int total_files;
+    int total_tasks;
+    int window;             // Máximo de tareas en vuelo (cargadas y sin escribir)
+    int loaded_count;       // Los archivos [0, loaded_count) ya los cargó el lector (atómico)
+    int next_task;          // Próxima tarea para un codificador (fetch-add atómico)
+    int written_tasks;      // Tareas ya escritas en el contenedor (atómico)
+    pthread_mutex_t mutex;
+    pthread_cond_t file_loaded;
+    pthread_cond_t result_ready;
+    pthread_cond_t window_moved;
+} compress_pipeline_t;
+
+// --- Datos para los Hilos ---
+typedef struct {
+    int thread_id;
+    char** file_list;
+    int total_files;
+    int* next_file_index;                          // Se reparte con fetch-add atómico
+    compress_pipeline_t* pipeline;                 // Solo para compresión
+    const char* archive_path;                      // Solo para descompresión
+    const struct archiveDirectory* directory;      // Solo para descompresión
+    const int* order;                              // Solo para descompresión: más grandes primero
+    bool* failed;                                  // Solo para descompresión: algún miembro falló (atómico)
+} thread_data_t;
+
+// Orden descendente por tamaño: los archivos grandes se empiezan primero
+static int compareScannedBySize(const void* a, const void* b) {
+    long long sizeA = ((const struct walkEntry*)a)->size;
+    long long sizeB = ((const struct walkEntry*)b)->size;
+    return (sizeA < sizeB) - (sizeA > sizeB);
+}
+
+// --- Un miembro a descomprimir, para ordenarlos por tamaño ---
+typedef struct {
+    long long size;
+    int index;
+} sized_task_t;
+
+static int compareTasksBySize(const void* a, const void* b) {
+    long long sizeA = ((const sized_task_t*)a)->size;
+    long long sizeB = ((const sized_task_t*)b)->size;
+    return (sizeA < sizeB) - (sizeA > sizeB);
+}
+
+/**
+ * @brief Etapa 1: lee los archivos en orden y los deja en memoria para los
+ * codificadores, sin adelantarse más de 'window' tareas al escritor. De los
+ * grandes decide si sus bloques van al pool o si el escritor los comprime enteros.
+ */
+void* read_worker(void* arg) {
+    compress_pipeline_t* pipeline = (compress_pipeline_t*)arg;
+
+    for (int i = 0; i < pipeline->total_files; i++) {
+        pipeline_item_t* item = &pipeline->items[i];
+        pthread_mutex_lock(&pipeline->mutex);
+        while (item->first_task >= pipeline->written_tasks + pipeline->window) {
+            pthread_cond_wait(&pipeline->window_moved, &pipeline->mutex);
+        }
+        pthread_mutex_unlock(&pipeline->mutex);
+
+        item->readable = openInputView(pipeline->file_list[i], &item->view);
+        if (!item->readable) {
+            fprintf(stderr, "Error al abrir archivo de entrada: %s\n", pipeline->file_list[i]);
+        } else if (item->large) {
+            item->original_size = (long long)item->view.size;
+            // Se parte solo si sigue midiendo lo que vio el recorrido y va por bloques
+            // (los incompresibles o con puntos de sincronización los hace el escritor)
+            item->split = blockCountFor(item->view.size) == item->task_count && fileMemberUsesBlocks(&item->view);
+            if (!item->split) {
+                closeInputView(&item->view);
+            }
+        } else {
+            item->original_size = (long long)item->view.size;
+            prefetchInputView(&item->view);
+        }
+
+        pthread_mutex_lock(&pipeline->mutex);
+        __atomic_store_n(&pipeline->loaded_count, i + 1, __ATOMIC_RELEASE);
+        pthread_cond_broadcast(&pipeline->file_loaded);
+        pthread_mutex_unlock(&pipeline->mutex);
+    }
+    return NULL;
+}
+
+// --- Esto hace cada thread ---
+/**
+ * @brief Etapa 2: cada hilo toma la próxima tarea (un archivo chico o un bloque
+ * de uno grande) y la comprime a memoria; el escritor la agrega al contenedor.
+ */
+void* compress_worker(void* arg) {
+    thread_data_t* data = (thread_data_t*)arg;
+    compress_pipeline_t* pipeline = data->pipeline;
+
+    while (true) {
+        // Tomar la próxima tarea sin candado
+        int current_task = __atomic_fetch_add(&pipeline->next_task, 1, __ATOMIC_RELAXED);
+        if (current_task >= pipeline->total_tasks) {
+            break; // No hay más tareas, el hilo termina
+        }
+        pipeline_task_t* task = &pipeline->tasks[current_task];
+
+        // Solo se bloquea si el lector todavía no cargó su archivo o si el
+        // escritor quedó más de 'window' tareas atrás
+        if (__atomic_load_n(&pipeline->loaded_count, __ATOMIC_ACQUIRE) <= task->item ||
+            current_task >= __atomic_load_n(&pipeline->written_tasks, __ATOMIC_ACQUIRE) + pipeline->window) {
+            pthread_mutex_lock(&pipeline->mutex);
+            while (__atomic_load_n(&pipeline->loaded_count, __ATOMIC_ACQUIRE) <= task->item) {
+                pthread_cond_wait(&pipeline->file_loaded, &pipeline->mutex);
+            }
+            while (current_task >= pipeline->written_tasks + pipeline->window) {
+                pthread_cond_wait(&pipeline->window_moved, &pipeline->mutex);
+            }
+            pthread_mutex_unlock(&pipeline->mutex);
+        }
+
+        pipeline_item_t* item = &pipeline->items[task->item];
+        bool ok = true;
+        unsigned char* result = NULL;
+        size_t result_size = 0;
+        if (!item->large) {
+            ok = false;
+            if (item->readable) {
+                printf("[Hilo %d] Comprimiendo: %s\n", data->thread_id, pipeline->file_list[task->item]);
+                ok = encodeMemberToMemory(item->view.data, item->view.size, &result, &result_size);
+                closeInputView(&item->view);
+            }
+        } else if (item->split) {
+            // Cada bloque es un miembro canónico independiente, como en compressBlocks
+            size_t start = (size_t)task->block * HUFF_BLOCK_SIZE;
+            size_t length = (item->view.size - start < HUFF_BLOCK_SIZE) ? item->view.size - start : HUFF_BLOCK_SIZE;
+            ok = encodeMemberToMemory(item->view.data + start, length, &result, &result_size);
+        } // Si no, el escritor comprime el archivo entero y la tarea no hace nada
+
+        pthread_mutex_lock(&pipeline->mutex);
+        task->data = result;
+        task->size = result_size;
+        task->ok = ok;
+        task->done = true;
+        pthread_cond_broadcast(&pipeline->result_ready);
+        pthread_mutex_unlock(&pipeline->mutex);
+    }
+
+    return NULL;
+}
+
+// El escritor espera a que una tarea tenga su resultado
+static pipeline_task_t* wait_for_task(compress_pipeline_t* pipeline, int index) {
+    pipeline_task_t* task = &pipeline->tasks[index];
+    pthread_mutex_lock(&pipeline->mutex);
+    while (!task->done) {
+        pthread_cond_wait(&pipeline->result_ready, &pipeline->mutex);
+    }
+    pthread_mutex_unlock(&pipeline->mutex);
+    return task;
+}
+
+// El escritor avisa que las tareas [0, count) ya están en el contenedor
+static void mark_tasks_written(compress_pipeline_t* pipeline, int count) {
+    pthread_mutex_lock(&pipeline->mutex);
+    __atomic_store_n(&pipeline->written_tasks, count, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&pipeline->window_moved);
+    pthread_mutex_unlock(&pipeline->mutex);
+}
+
+/**
+ * @brief Escribe un archivo grande como contenedor por bloques a medida que el
+ * pool termina sus bloques, y lo registra en el directorio.
+ */
+static bool write_split_item(compress_pipeline_t* pipeline, pipeline_item_t* item, FILE* output,
+                             struct archiveDirectory* directory, const char* name) {
+    long long offset = ftell(output);
+    struct blockContainer container;
+    bool started = beginBlockContainer(&container, output, item->view.size);
+    bool written = started;
+    for (int b = 0; b < item->task_count; b++) {
+        int index = item->first_task + b;
+        pipeline_task_t* task = wait_for_task(pipeline, index);
+        if (written && task->ok) {
+            writeContainerBlock(&container, task->data, task->size);
+        } else {
+            written = false;
+        }
+        free(task->data);
+        task->data = NULL;
+        mark_tasks_written(pipeline, index + 1);
+    }
+    if (started) {
+        written = finishBlockContainer(&container, written);
+    }
+    closeInputView(&item->view);
+    return finishArchiveMember(output, directory, name, offset, item->original_size, written);
+}
+
+// --- Función Principal de Compresión con Pthreads ---
+
+/**
+ * @brief Comprime un directorio con un pipeline de tres etapas: un hilo lector
+ * precarga los archivos, un pool de hilos los comprime a memoria (los archivos
+ * grandes, de a un bloque por tarea) y el hilo principal los escribe en orden. Las etapas se conectan con una ventana
+ * acotada, así la memoria no crece con el tamaño del directorio.
+ * @param inputDir Directorio de entrada.
+ * @param outputFile Archivo binario de salida.
+ * @return true si la compresión fue exitosa, false en caso contrario.
+ */
+bool compressDirectoryPthread(const char* inputDir, const char* outputFile) {
+    // 1. Obtener el número de núcleos de CPU para definir el número de hilos
+    long num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (num_threads <= 0) {
+        num_threads = 2; // Valor por defecto si falla la detección
+    }
+    printf("Iniciando compresión con %ld hilos...\n", num_threads);
+
+    // 2. Recorrer el árbol en paralelo (openat/fstatat) y listar archivos a comprimir
+    int file_count;
+    struct walkEntry* scanned = walkDirectory(inputDir, &file_count);
+    if (scanned == NULL) {
+        return false;
+    }
+    if (file_count == 0) {
+        printf("No se encontraron archivos en el directorio.\n");
+        freeWalkEntries(scanned, file_count);
+        return false;
+    }
+
+    // Asignar memoria para las listas de archivos
+    char** file_list = malloc(file_count * sizeof(char*));
+    char** original_filenames = malloc(file_count * sizeof(char*));
+    pipeline_item_t* items = calloc(file_count, sizeof(pipeline_item_t));
+
+    // Los más grandes primero: así ningún archivo enorme queda para el final
+    // con el resto de los hilos sin trabajo. Los que pasan el umbral se parten
+    // en tareas de un bloque, que toman los mismos hilos que los archivos chicos.
+    qsort(scanned, file_count, sizeof(struct walkEntry), compareScannedBySize);
+    int task_count = 0;
+    for (int i = 0; i < file_count; i++) {
+        file_list[i] = scanned[i].path;
+        original_filenames[i] = scanned[i].name;
+        items[i].large = scanned[i].size >= (long long)HUFF_BLOCK_THRESHOLD;
+        items[i].first_task = task_count;
+        items[i].task_count = items[i].large ? blockCountFor((size_t)scanned[i].size) : 1;
+        task_count += items[i].task_count;
+    }
+    pipeline_task_t* tasks = calloc(task_count, sizeof(pipeline_task_t));
+    if (file_list == NULL || original_filenames == NULL || items == NULL || tasks == NULL) {
+        perror("Fallo de memoria para el pipeline");
+        freeWalkEntries(scanned, file_count);
+        free(file_list);
+        free(original_filenames);
+        free(items);
+        free(tasks);
+        return false;
+    }
+    for (int i = 0; i < file_count; i++) {
+        for (int b = 0; b < items[i].task_count; b++) {
+            tasks[items[i].first_task + b].item = i;
+            tasks[items[i].first_task + b].block = b;
+        }
+    }
+
+    FILE* final_output = fopen(outputFile, "wb+");
+    if (final_output == NULL) {
+        perror("Error al crear el archivo de salida");
+        freeWalkEntries(scanned, file_count);
+        free(file_list);
+        free(original_filenames);
+        free(items);
+        free(tasks);
+        return false;
+    }
+    writeArchiveHeader(final_output);
+    struct archiveDirectory directory = { ARCHIVE_VERSION, 0, 0, NULL };
+
+    // 3. Inicializar el pipeline
+    compress_pipeline_t pipeline = {
+        .file_list = file_list,
+        .items = items,
+        .tasks = tasks,
+        .total_files = file_count,
+        .total_tasks = task_count,
+        .window = 2 * (int)num_threads,
+        .loaded_count = 0,
+        .next_task = 0,
+        .written_tasks = 0
+    };
+    pthread_mutex_init(&pipeline.mutex, NULL);
+    pthread_cond_init(&pipeline.file_loaded, NULL);
+    pthread_cond_init(&pipeline.result_ready, NULL);
+    pthread_cond_init(&pipeline.window_moved, NULL);
+
+    // 4. Lanzar el lector y el pool de codificadores
+    pthread_t reader;
+    pthread_create(&reader, NULL, read_worker, &pipeline);
+    pthread_t threads[num_threads];
+    thread_data_t thread_data[num_threads];
+    for (long i = 0; i < num_threads; i++) {
+        thread_data[i] = (thread_data_t){
+            .thread_id = i,
+            .file_list = file_list,
+            .total_files = file_count,
+            .pipeline = &pipeline
+        };
+        pthread_create(&threads[i], NULL, compress_worker, &thread_data[i]);
+    }
+
+    // 5. Escritor: agrega cada archivo en orden apenas está listo; los bloques de
+    //    los grandes se van escribiendo a medida que el pool los termina
+    printf("Combinando %d archivos comprimidos...\n", file_count);
+    bool ok = true;
+    for (int i = 0; i < file_count; i++) {
+        pipeline_item_t* item = &items[i];
+        // Esperar la primera tarea también asegura que el lector ya decidió si se parte
+        pipeline_task_t* first = wait_for_task(&pipeline, item->first_task);
+        if (!item->large) {
+            ok &= first->ok && appendArchiveMember(final_output, &directory, original_filenames[i],
+                                                   first->data, first->size, item->original_size);
+            free(first->data);
+            first->data = NULL;
+        } else if (item->split) {
+            printf("[Principal] Combinando %d bloques: %s\n", item->task_count, file_list[i]);
+            ok &= write_split_item(&pipeline, item, final_output, &directory, original_filenames[i]);
+        } else {
+            // Incompresible, con puntos de sincronización o cambió desde el recorrido
+            printf("[Principal] Comprimiendo: %s\n", file_list[i]);
+            ok &= compressArchiveMember(final_output, &directory, original_filenames[i], file_list[i]);
+        }
+        mark_tasks_written(&pipeline, item->first_task + item->task_count);
+    }
+
+    // 6. Esperar a que todos los hilos terminen y cerrar el contenedor
+    pthread_join(reader, NULL);
+    for (long i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    writeArchiveDirectory(final_output, &directory);
+    freeArchiveDirectory(&directory);
+    fclose(final_output);
+
+    // 7. Limpieza de memoria
+    freeWalkEntries(scanned, file_count);
+    free(file_list);
+    free(original_filenames);
+    free(items);
+    free(tasks);
+    pthread_mutex_destroy(&pipeline.mutex);
+    pthread_cond_destroy(&pipeline.file_loaded);
+    pthread_cond_destroy(&pipeline.result_ready);
+    pthread_cond_destroy(&pipeline.window_moved);
+
+    printf("¡Compresión con Pthreads completada!\n");
+    return ok;
+}
+
+// --- AÑADE ESTO AL FINAL DE readFile_pthread.c ---
+
+/**
+ * @brief Función que ejecuta cada hilo para descomprimir archivos.
+ */
+void* decompress_worker(void* arg) {
+    thread_data_t* data = (thread_data_t*)arg;
+
+    // Cada hilo usa su propio FILE* sobre el contenedor
+    FILE* input = fopen(data->archive_path, "rb");
+    if (!input) {
+        perror("Error al abrir archivo comprimido");
+        __atomic_store_n(data->failed, true, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    while (true) {
+        // Tomar el próximo trabajo sin candado
+        int next = __atomic_fetch_add(data->next_file_index, 1, __ATOMIC_RELAXED);
+        if (next >= data->total_files) {
+            break; // No hay más trabajo
+        }
+        int current_file_index = data->order[next];
+
+        const struct archiveEntry* member = &data->directory->entries[current_file_index];
+        const char* final_output_path = data->file_list[current_file_index];
+
+        printf("[Hilo %d] Descomprimiendo: %s -> %s\n", data->thread_id, member->name, final_output_path);
+
+        // Salta directo al miembro usando el directorio central
+        if (!extractArchiveMember(input, member, final_output_path)) {
+            __atomic_store_n(data->failed, true, __ATOMIC_RELAXED);
+        }
+    }
+    fclose(input);
+    return NULL;
+}
+
+/**
+ * @brief Descomprime un directorio usando un pool de hilos (pthreads).
+ * @param compressedFile Archivo .bin a descomprimir.
+ * @param outputDir Directorio de salida.
+ * @return true si la descompresión fue exitosa, false en caso contrario.
+ */
+bool decompressDirectoryPthread(const char* compressedFile, const char* outputDir) {
+    long num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (num_threads <= 0) num_threads = 2;
+    printf("Iniciando descompresión con %ld hilos...\n", num_threads);
+
+    FILE* input = fopen(compressedFile, "rb");
+    if (!input) {
+        perror("Error al abrir archivo comprimido");
+        return false;
+    }
+    if (!createDirectoryIfNotExists(outputDir)) {
+        fclose(input);
+        return false;
+    }
+
+    // 1. Leer el directorio central; no hace falta copiar nada a temporales
+    struct archiveDirectory directory;
+    if (!readArchiveDirectory(input, &directory)) {
+        freeArchiveDirectory(&directory);
+        fclose(input);
+        return false;
+    }
+    fclose(input);
+    int file_count = directory.count;
+
+    char** final_file_list = malloc(file_count * sizeof(char*));
+    for (int i = 0; i < file_count; i++) {
+        char final_path[1024];
+        snprintf(final_path, sizeof(final_path), "%s/%s", outputDir, directory.entries[i].name);
+        final_file_list[i] = strdup(final_path);
+    }
+
+    // Los miembros más grandes primero (los de bloques se descomprimen con
+    // varios hilos por dentro); el formato viejo solo tiene el tamaño comprimido
+    sized_task_t* tasks = malloc((file_count > 0 ? file_count : 1) * sizeof(sized_task_t));
+    int* order = malloc((file_count > 0 ? file_count : 1) * sizeof(int));
+    for (int i = 0; i < file_count; i++) {
+        const struct archiveEntry* member = &directory.entries[i];
+        tasks[i].size = (member->originalSize >= 0) ? member->originalSize : member->compressedSize;
+        tasks[i].index = i;
+    }
+    qsort(tasks, file_count, sizeof(sized_task_t), compareTasksBySize);
+    for (int i = 0; i < file_count; i++) {
+        order[i] = tasks[i].index;
+    }
+    free(tasks);
+
+    // 2. Lanzar hilos para descomprimir directo desde el contenedor
+    pthread_t threads[num_threads];
+    thread_data_t thread_data[num_threads];
+    int next_file_index = 0;
+    bool failed = false;
+
+    for (long i = 0; i < num_threads; i++) {
+        thread_data[i] = (thread_data_t){
+            .thread_id = i,
+            .file_list = final_file_list,
+            .pipeline = NULL,
+            .total_files = file_count,
+            .next_file_index = &next_file_index,
+            .archive_path = compressedFile,
+            .directory = &directory,
+            .order = order,
+            .failed = &failed
+        };
+        pthread_create(&threads[i], NULL, decompress_worker, &thread_data[i]);
+    }
+
+    // 3. Esperar y limpiar
+    for (long i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    for (int i = 0; i < file_count; i++) {
+        free(final_file_list[i]);
+    }
+    free(final_file_list);
+    free(order);
+    freeArchiveDirectory(&directory);
+
+    if (failed) {
+        fprintf(stderr, "Error: no se pudieron extraer todos los archivos\n");
+        return false;
+    }
+    printf("¡Descompresión con Pthreads completada!\n");
+    return true;
 }
\ No newline at end of file
@@ -0,0 +1,291 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "tree.h"
+
+//--------------------------------------------------------------------------//
+//                                                                          //
+//          Transformada previa: Burrows-Wheeler + MTF + rachas de 0        //
+//                                                                          //
+//--------------------------------------------------------------------------//
+
+/**
+ * @brief Transformada de Burrows-Wheeler de un bloque, sobre rotaciones cíclicas
+ * (sin centinela). Las rotaciones se ordenan duplicando en cada pasada el prefijo
+ * comparado: el par (rango de i, rango de i + k) se ordena con dos counting sorts,
+ * así que cada pasada es O(n) y termina cuando todos los rangos son distintos.
+ * @param data Bloque original de n bytes.
+ * @param out Recibe la última columna de las rotaciones ordenadas (n bytes).
+ * @return La fila de la rotación 0 (índice primario), o -1 si falta memoria.
+ */
+int bwtForward(const unsigned char* data, int n, unsigned char* out) {
+    if (n <= 0) {
+        return 0;
+    }
+    int* sa = (int*)malloc(n * sizeof(int));
+    int* rank = (int*)malloc(n * sizeof(int));
+    int* tmp = (int*)malloc(n * sizeof(int));
+    int* count = (int*)malloc((n > 256 ? n : 256) * sizeof(int));
+    if (sa == NULL || rank == NULL || tmp == NULL || count == NULL) {
+        free(sa); free(rank); free(tmp); free(count);
+        return -1;
+    }
+
+    // Orden inicial: por el primer byte
+    memset(count, 0, 256 * sizeof(int));
+    for (int i = 0; i < n; i++) count[data[i]]++;
+    for (int c = 1; c < 256; c++) count[c] += count[c - 1];
+    for (int i = n - 1; i >= 0; i--) sa[--count[data[i]]] = i;
+    int classes = 1;
+    rank[sa[0]] = 0;
+    for (int j = 1; j < n; j++) {
+        if (data[sa[j]] != data[sa[j - 1]]) classes++;
+        rank[sa[j]] = classes - 1;
+    }
+
+    for (long k = 1; k < n && classes < n; k <<= 1) {
+        // Orden por la segunda mitad: la rotación i - k va donde está la i
+        for (int j = 0; j < n; j++) {
+            long p = sa[j] - k;
+            tmp[j] = (int)(p < 0 ? p + n : p);
+        }
+        // Counting sort estable por la primera mitad
+        memset(count, 0, classes * sizeof(int));
+        for (int j = 0; j < n; j++) count[rank[tmp[j]]]++;
+        for (int c = 1; c < classes; c++) count[c] += count[c - 1];
+        for (int j = n - 1; j >= 0; j--) sa[--count[rank[tmp[j]]]] = tmp[j];
+
+        // Rangos nuevos (tmp ya no se usa)
+        classes = 1;
+        tmp[sa[0]] = 0;
+        for (int j = 1; j < n; j++) {
+            int current = sa[j];
+            int previous = sa[j - 1];
+            long currentSecond = current + k;
+            long previousSecond = previous + k;
+            if (currentSecond >= n) currentSecond -= n;
+            if (previousSecond >= n) previousSecond -= n;
+            if (rank[current] != rank[previous] || rank[currentSecond] != rank[previousSecond]) classes++;
+            tmp[current] = classes - 1;
+        }
+        int* swap = rank;
+        rank = tmp;
+        tmp = swap;
+    }
+
+    int primary = 0;
+    for (int j = 0; j < n; j++) {
+        int p = sa[j];
+        out[j] = data[(p == 0) ? n - 1 : p - 1];
+        if (p == 0) primary = j;
+    }
+    free(sa);
+    free(rank);
+    free(tmp);
+    free(count);
+    return primary;
+}
+
+/**
+ * @brief Deshace bwtForward: la fila r es la rotación s, y next[r] es la fila de
+ * la rotación s + 1, así que basta seguir next desde la fila primaria.
+ * @return false si el índice primario es inválido o falta memoria.
+ */
+bool bwtInverse(const unsigned char* in, int n, int primary, unsigned char* out) {
+    if (n <= 0) {
+        return true;
+    }
+    if (primary < 0 || primary >= n) {
+        return false;
+    }
+    int* next = (int*)malloc(n * sizeof(int));
+    if (next == NULL) {
+        return false;
+    }
+
+    int start[256] = { 0 };
+    for (int i = 0; i < n; i++) start[in[i]]++;
+    for (int c = 0, sum = 0; c < 256; c++) {
+        int value = start[c];
+        start[c] = sum;
+        sum += value;
+    }
+    for (int i = 0; i < n; i++) next[start[in[i]]++] = i;
+
+    int p = next[primary];
+    for (int j = 0; j < n; j++) {
+        out[j] = in[p];
+        p = next[p];
+    }
+    free(next);
+    return true;
+}
+
+/**
+ * @brief Move-to-front en el lugar: cada byte se cambia por su posición en una
+ * lista que empieza ordenada y pone al frente el último byte visto. Después de
+ * la BWT quedan sobre todo ceros y números chicos.
+ */
+void mtfEncode(unsigned char* data, size_t size) {
+    unsigned char order[256];
+    for (int i = 0; i < 256; i++) order[i] = (unsigned char)i;
+    for (size_t i = 0; i < size; i++) {
+        unsigned char symbol = data[i];
+        int j = 0;
+        while (order[j] != symbol) j++;
+        memmove(order + 1, order, j);
+        order[0] = symbol;
+        data[i] = (unsigned char)j;
+    }
+}
+
+void mtfDecode(unsigned char* data, size_t size) {
+    unsigned char order[256];
+    for (int i = 0; i < 256; i++) order[i] = (unsigned char)i;
+    for (size_t i = 0; i < size; i++) {
+        int j = data[i];
+        unsigned char symbol = order[j];
+        memmove(order + 1, order, j);
+        order[0] = symbol;
+        data[i] = symbol;
+    }
+}
+
+/**
+ * @brief Comprime las rachas de ceros: un cero solo queda igual; una racha de
+ * L >= 2 ceros se escribe como 0, 0 y L - 2 en bytes (255 = "sigue").
+ * @param out Debe tener lugar para ZERO_RUN_BOUND(size) bytes.
+ * @return Los bytes escritos en out.
+ */
+size_t zeroRunEncode(const unsigned char* in, size_t size, unsigned char* out) {
+    size_t written = 0;
+    size_t i = 0;
+    while (i < size) {
+        if (in[i] != 0) {
+            out[written++] = in[i++];
+            continue;
+        }
+        size_t run = 0;
+        while (i < size && in[i] == 0) { run++; i++; }
+        out[written++] = 0;
+        if (run == 1) continue;
+        out[written++] = 0;
+        size_t rest = run - 2;
+        while (rest >= 255) {
+            out[written++] = 255;
+            rest -= 255;
+        }
+        out[written++] = (unsigned char)rest;
+    }
+    return written;
+}
+
+/**
+ * @brief Deshace zeroRunEncode.
+ * @return false si los datos no dan exactamente expectedSize bytes.
+ */
+bool zeroRunDecode(const unsigned char* in, size_t size, unsigned char* out, size_t expectedSize) {
+    size_t written = 0;
+    size_t i = 0;
+    while (i < size) {
+        if (in[i] != 0) {
+            if (written == expectedSize) return false;
+            out[written++] = in[i++];
+            continue;
+        }
+        size_t run = 1;
+        i++;
+        if (i < size && in[i] == 0) {
+            run = 2;
+            i++;
+            while (i < size && in[i] == 255) { run += 255; i++; }
+            if (i == size) return false;
+            run += in[i++];
+        }
+        if (run > expectedSize - written) return false;
+        memset(out + written, 0, run);
+        written += run;
+    }
+    return written == expectedSize;
+}
+
+// --- BWT por bloques en paralelo ---
+int transformBlockCount(size_t size) {
+    return (int)((size + HUFF_TRANSFORM_BLOCK_SIZE - 1) / HUFF_TRANSFORM_BLOCK_SIZE);
+}
+
+typedef struct {
+    const unsigned char* in;
+    unsigned char* out;
+    size_t size;
+    int* primary;          // Índice primario de cada bloque
+    int block_count;
+    bool inverse;
+    int next_block;        // Se reparte con fetch-add atómico
+    bool failed;
+} bwt_job_t;
+
+void* bwt_worker(void* arg) {
+    bwt_job_t* job = (bwt_job_t*)arg;
+    int block;
+    while ((block = __atomic_fetch_add(&job->next_block, 1, __ATOMIC_RELAXED)) < job->block_count) {
+        size_t start = (size_t)block * HUFF_TRANSFORM_BLOCK_SIZE;
+        int length = (int)((job->size - start < HUFF_TRANSFORM_BLOCK_SIZE) ? job->size - start : HUFF_TRANSFORM_BLOCK_SIZE);
+        bool ok;
+        if (job->inverse) {
+            ok = bwtInverse(job->in + start, length, job->primary[block], job->out + start);
+        } else {
+            job->primary[block] = bwtForward(job->in + start, length, job->out + start);
+            ok = job->primary[block] >= 0;
+        }
+        if (!ok) {
+            __atomic_store_n(&job->failed, true, __ATOMIC_RELAXED);
+        }
+    }
+    return NULL;
+}
+
+// Reparte los bloques de HUFF_TRANSFORM_BLOCK_SIZE entre hilos (uno solo si hay un bloque)
+static bool runBwtBlocks(bwt_job_t* job) {
+    int threadCount = getWorkerCount();
+    if (threadCount > job->block_count) threadCount = job->block_count;
+    if (threadCount <= 1) {
+        bwt_worker(job);
+        return !job->failed;
+    }
+
+    pthread_t* threads = (pthread_t*)malloc(threadCount * sizeof(pthread_t));
+    if (threads == NULL) {
+        bwt_worker(job);
+        return !job->failed;
+    }
+    int started = 0;
+    for (; started < threadCount; started++) {
+        if (pthread_create(&threads[started], NULL, bwt_worker, job) != 0) break;
+    }
+    if (started == 0) {
+        bwt_worker(job);
+    }
+    for (int t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    free(threads);
+    return !job->failed;
+}
+
+/**
+ * @brief BWT de cada bloque de HUFF_TRANSFORM_BLOCK_SIZE bytes, en paralelo.
+ * @param primary Recibe el índice primario de cada bloque (transformBlockCount(size)).
+ */
+bool bwtForwardBlocks(const unsigned char* data, size_t size, unsigned char* out, int* primary) {
+    bwt_job_t job = { data, out, size, primary, transformBlockCount(size), false, 0, false };
+    return runBwtBlocks(&job);
+}
+
+bool bwtInverseBlocks(const unsigned char* in, size_t size, int* primary, unsigned char* out) {
+    bwt_job_t job = { in, out, size, primary, transformBlockCount(size), true, 0, false };
+    return runBwtBlocks(&job);
+}
@@ -0,0 +1,271 @@
+#define _DEFAULT_SOURCE  // d_type y DT_* de dirent.h
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "tree.h"
+
+//--------------------------------------------------------------------------//
+//                                                                          //
+//            Recorrido recursivo de directorios con varios hilos           //
+//                                                                          //
+//--------------------------------------------------------------------------//
+
+// Mínimo de hilos del recorrido: casi todo es esperar a fstatat/getdents,
+// así que conviene tener más pedidos en vuelo que núcleos
+#define WALK_MIN_THREADS 4
+
+// --- Estado compartido del recorrido ---
+typedef struct {
+    int root_fd;                // Todos los subdirectorios se abren con openat desde aquí
+    const char* input_dir;
+    char** pending;             // Subdirectorios por recorrer (rutas relativas; "" = la raíz)
+    int pending_count;
+    int pending_capacity;
+    int active;                 // Hilos recorriendo un directorio ahora
+    struct walkEntry* entries;  // Archivos regulares encontrados
+    int count;
+    int capacity;
+    bool failed;
+    pthread_mutex_t mutex;
+    pthread_cond_t work_ready;
+} walk_job_t;
+
+// Lo que encontró un hilo en un directorio; se agrega de una sola vez con el candado
+typedef struct {
+    struct walkEntry* files;
+    int file_count;
+    int file_capacity;
+    char** dirs;
+    int dir_count;
+    int dir_capacity;
+} walk_batch_t;
+
+static bool growArray(void** array, int* capacity, int count, size_t itemSize) {
+    if (count < *capacity) return true;
+    int grown = (*capacity == 0) ? 64 : *capacity * 2;
+    void* larger = realloc(*array, grown * itemSize);
+    if (larger == NULL) return false;
+    *array = larger;
+    *capacity = grown;
+    return true;
+}
+
+// Une dos partes de una ruta; si base está vacía devuelve una copia de name
+static char* joinPath(const char* base, const char* name) {
+    size_t baseLength = strlen(base);
+    size_t nameLength = strlen(name);
+    char* path = (char*)malloc(baseLength + nameLength + 2);
+    if (path == NULL) return NULL;
+    if (baseLength == 0) {
+        memcpy(path, name, nameLength + 1);
+    } else {
+        memcpy(path, base, baseLength);
+        path[baseLength] = '/';
+        memcpy(path + baseLength + 1, name, nameLength + 1);
+    }
+    return path;
+}
+
+/**
+ * @brief Lee un directorio (relativo a root_fd) y anota sus archivos regulares y
+ * sus subdirectorios en el lote. Con d_type solo hace falta fstatat para el tamaño;
+ * si el sistema de archivos devuelve DT_UNKNOWN, fstatat decide qué es cada entrada.
+ * Los enlaces simbólicos a archivos se siguen (como antes con stat), pero los
+ * enlaces a directorios no, para no entrar en ciclos.
+ * @return false solo si falta memoria.
+ */
+static bool scanDirectory(walk_job_t* job, const char* relative, walk_batch_t* batch) {
+    int fd = openat(job->root_fd, (relative[0] == '\0') ? "." : relative, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    DIR* dir = (fd >= 0) ? fdopendir(fd) : NULL;
+    if (dir == NULL) {
+        fprintf(stderr, "Error al abrir el directorio %s/%s\n", job->input_dir, relative);
+        if (fd >= 0) close(fd);
+        return true; // Se avisa y se sigue con el resto
+    }
+
+    bool ok = true;
+    struct dirent* entry;
+    while (ok && (entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+        struct stat st;
+        bool isDirectory = entry->d_type == DT_DIR;
+        if (!isDirectory) {
+            if (fstatat(dirfd(dir), entry->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                continue;
+            }
+            if (S_ISLNK(st.st_mode) && (fstatat(dirfd(dir), entry->d_name, &st, 0) != 0 || !S_ISREG(st.st_mode))) {
+                continue;
+            }
+            isDirectory = S_ISDIR(st.st_mode);
+            if (!isDirectory && !S_ISREG(st.st_mode)) {
+                continue;
+            }
+        }
+
+        char* name = joinPath(relative, entry->d_name);
+        if (name == NULL) {
+            ok = false;
+        } else if (strlen(name) > ARCHIVE_MAX_NAME) {
+            fprintf(stderr, "Aviso: ruta demasiado larga, se omite: %s\n", name);
+            free(name);
+        } else if (isDirectory) {
+            ok = growArray((void**)&batch->dirs, &batch->dir_capacity, batch->dir_count, sizeof(char*));
+            if (ok) batch->dirs[batch->dir_count++] = name;
+            else free(name);
+        } else {
+            char* path = joinPath(job->input_dir, name);
+            ok = path != NULL &&
+                 growArray((void**)&batch->files, &batch->file_capacity, batch->file_count, sizeof(struct walkEntry));
+            if (ok) {
+                batch->files[batch->file_count++] = (struct walkEntry){ path, name, (long long)st.st_size };
+            } else {
+                free(path);
+                free(name);
+            }
+        }
+    }
+    closedir(dir);
+    return ok;
+}
+
+/**
+ * @brief Cada hilo toma un subdirectorio pendiente, lo lee y agrega lo que
+ * encontró. Termina cuando no hay pendientes y ningún otro hilo puede agregar más.
+ */
+void* walk_worker(void* arg) {
+    walk_job_t* job = (walk_job_t*)arg;
+    walk_batch_t batch = { 0 };
+
+    pthread_mutex_lock(&job->mutex);
+    while (true) {
+        while (job->pending_count == 0 && job->active > 0) {
+            pthread_cond_wait(&job->work_ready, &job->mutex);
+        }
+        if (job->pending_count == 0 || job->failed) {
+            break;
+        }
+        char* relative = job->pending[--job->pending_count];
+        job->active++;
+        pthread_mutex_unlock(&job->mutex);
+
+        batch.file_count = 0;
+        batch.dir_count = 0;
+        bool ok = scanDirectory(job, relative, &batch);
+        free(relative);
+
+        pthread_mutex_lock(&job->mutex);
+        job->active--;
+        int merged = 0;
+        while (merged < batch.file_count &&
+               growArray((void**)&job->entries, &job->capacity, job->count, sizeof(struct walkEntry))) {
+            job->entries[job->count++] = batch.files[merged++];
+        }
+        int queued = 0;
+        while (queued < batch.dir_count &&
+               growArray((void**)&job->pending, &job->pending_capacity, job->pending_count, sizeof(char*))) {
+            job->pending[job->pending_count++] = batch.dirs[queued++];
+        }
+        if (merged < batch.file_count || queued < batch.dir_count) {
+            for (int i = merged; i < batch.file_count; i++) {
+                free(batch.files[i].path);
+                free(batch.files[i].name);
+            }
+            for (int i = queued; i < batch.dir_count; i++) free(batch.dirs[i]);
+            ok = false;
+        }
+        if (!ok) {
+            job->failed = true;
+        }
+        pthread_cond_broadcast(&job->work_ready);
+    }
+    pthread_cond_broadcast(&job->work_ready);
+    pthread_mutex_unlock(&job->mutex);
+
+    free(batch.files);
+    free(batch.dirs);
+    return NULL;
+}
+
+static int compareWalkEntries(const void* a, const void* b) {
+    return strcmp(((const struct walkEntry*)a)->name, ((const struct walkEntry*)b)->name);
+}
+
+/**
+ * @brief Busca todos los archivos regulares debajo de inputDir, recorriendo los
+ * subdirectorios en paralelo con openat/fstatat. El resultado queda ordenado por
+ * ruta relativa, así el contenedor sale igual sin importar qué hilo vio qué.
+ * @param count Recibe la cantidad de archivos.
+ * @return Arreglo de archivos (liberar con freeWalkEntries), o NULL si inputDir
+ * no se puede abrir o falta memoria.
+ */
+struct walkEntry* walkDirectory(const char* inputDir, int* count) {
+    *count = 0;
+    walk_job_t job = { 0 };
+    job.input_dir = inputDir;
+    job.root_fd = open(inputDir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (job.root_fd < 0) {
+        perror("Error al abrir el directorio");
+        return NULL;
+    }
+    job.pending = (char**)malloc(sizeof(char*));
+    job.entries = (struct walkEntry*)malloc(sizeof(struct walkEntry));
+    if (job.pending == NULL || job.entries == NULL || (job.pending[0] = strdup("")) == NULL) {
+        free(job.pending);
+        free(job.entries);
+        close(job.root_fd);
+        return NULL;
+    }
+    job.pending_count = 1;
+    job.pending_capacity = 1;
+    job.capacity = 1;
+    pthread_mutex_init(&job.mutex, NULL);
+    pthread_cond_init(&job.work_ready, NULL);
+
+    int threadCount = getWorkerCount();
+    if (threadCount < WALK_MIN_THREADS) threadCount = WALK_MIN_THREADS;
+    pthread_t* threads = (pthread_t*)malloc(threadCount * sizeof(pthread_t));
+    int started = 0;
+    for (; threads != NULL && started < threadCount; started++) {
+        if (pthread_create(&threads[started], NULL, walk_worker, &job) != 0) break;
+    }
+    if (started == 0) {
+        walk_worker(&job);
+    }
+    for (int t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    free(threads);
+
+    for (int i = 0; i < job.pending_count; i++) free(job.pending[i]);
+    free(job.pending);
+    pthread_mutex_destroy(&job.mutex);
+    pthread_cond_destroy(&job.work_ready);
+    close(job.root_fd);
+
+    if (job.failed) {
+        fprintf(stderr, "Error: falta memoria para recorrer %s\n", inputDir);
+        freeWalkEntries(job.entries, job.count);
+        return NULL;
+    }
+    qsort(job.entries, job.count, sizeof(struct walkEntry), compareWalkEntries);
+    *count = job.count;
+    return job.entries;
+}
+
+void freeWalkEntries(struct walkEntry* entries, int count) {
+    if (entries == NULL) return;
+    for (int i = 0; i < count; i++) {
+        free(entries[i].path);
+        free(entries[i].name);
+    }
+    free(entries);
+}
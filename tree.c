@@ -77,6 +77,12 @@ struct treeNode* getMin(struct NodeList** head) {
     return minNode;
 }
 
+/*
+    Versión con lista ordenada y un malloc por nodo. Se conserva porque los
+    archivos del formato viejo (tabla de frecuencias) se decodifican rehaciendo
+    exactamente este árbol, con esta forma de romper empates. Para todo lo demás
+    usar buildHuffmanTreeArray().
+*/
 struct treeNode* buildHuffmanTree(struct letter* letters, int size) {
     struct NodeList* priorityQueue = NULL;
     // Convertir a las letras en nodos para el arbol
@@ -107,6 +113,79 @@ struct treeNode* buildHuffmanTree(struct letter* letters, int size) {
     return getMin(&priorityQueue);
 }
 
+// Orden ascendente por frecuencia; los empates se rompen por símbolo
+static int compareNodesByFrequency(const void* a, const void* b) {
+    const struct treeNode* left = (const struct treeNode*)a;
+    const struct treeNode* right = (const struct treeNode*)b;
+    if (left->frequency != right->frequency) {
+        return (left->frequency < right->frequency) ? -1 : 1;
+    }
+    return (int)left->value - (int)right->value;
+}
+
+/*
+    Construcción con dos colas (O(n) después de ordenar las hojas)
+    --------------------------------------------------------
+    1- Las hojas se ordenan de menor a mayor frecuencia en nodes[0..n-1].
+
+    2- Los nodos internos se van creando en nodes[n..], y como cada uno
+    suma los dos menores disponibles, salen ya ordenados: esa es la segunda cola.
+
+    3- En cada paso se toman los dos menores de los frentes de las dos colas.
+    En empate se prefiere la hoja, lo que mantiene los códigos más cortos.
+
+    Sin malloc por nodo y sin lista enlazada.
+    -------------------------------------------------------
+*/
+static struct treeNode* takeMinNode(struct huffmanTree* tree, int* leafIndex, int leafCount, int* internalIndex) {
+    if (*leafIndex < leafCount &&
+        (*internalIndex >= tree->count || tree->nodes[*leafIndex].frequency <= tree->nodes[*internalIndex].frequency)) {
+        return &tree->nodes[(*leafIndex)++];
+    }
+    return &tree->nodes[(*internalIndex)++];
+}
+
+/**
+ * @brief Construye el árbol de Huffman dentro de un arreglo fijo de 511 nodos.
+ * @param tree Almacenamiento del árbol (puede estar en el stack).
+ * @param frequencies Arreglo de 256 frecuencias.
+ * @return La raíz (dentro de tree->nodes), o NULL si no hay símbolos.
+ */
+struct treeNode* buildHuffmanTreeArray(struct huffmanTree* tree, const unsigned long long* frequencies) {
+    int leafCount = 0;
+    for (int i = 0; i < 256; i++) {
+        if (frequencies[i] > 0) {
+            struct treeNode* leaf = &tree->nodes[leafCount++];
+            leaf->value = (unsigned char)i;
+            leaf->frequency = frequencies[i];
+            leaf->left = NULL;
+            leaf->right = NULL;
+        }
+    }
+    tree->count = leafCount;
+    tree->root = NULL;
+    if (leafCount == 0) {
+        return NULL;
+    }
+    qsort(tree->nodes, leafCount, sizeof(struct treeNode), compareNodesByFrequency);
+
+    int leafIndex = 0;
+    int internalIndex = leafCount;
+    for (int merges = 0; merges < leafCount - 1; merges++) {
+        struct treeNode* left = takeMinNode(tree, &leafIndex, leafCount, &internalIndex);
+        struct treeNode* right = takeMinNode(tree, &leafIndex, leafCount, &internalIndex);
+
+        struct treeNode* parentNode = &tree->nodes[tree->count++];
+        parentNode->value = '$'; //$ as placeholder for internal nodes
+        parentNode->frequency = left->frequency + right->frequency;
+        parentNode->left = left;
+        parentNode->right = right;
+    }
+
+    tree->root = &tree->nodes[tree->count - 1];
+    return tree->root;
+}
+
 // This function recursively traverses the tree to generate codes.
 void generateCodes(struct treeNode* root, char* path, int depth, char** huffman_codes) {
     if (root == NULL) {
@@ -139,3 +218,418 @@ void freeTree(struct treeNode* root) {
     freeTree(root->right);
     free(root);
 }
+
+
+/*------------------------------------------------------
+
+> Tablas de decodificación (varios bits por paso).
+
+------------------------------------------------------*/
+
+/**
+ * @brief Convierte los códigos en texto ("0101") a códigos empaquetados.
+ * @param huffman_codes Tabla de 256 strings, NULL si el símbolo no aparece.
+ * @param codes Arreglo de 256 huffCode a llenar (length 0 = sin código).
+ * @return false si algún código es inválido o no cabe en 64 bits.
+ */
+bool codesFromStrings(char** huffman_codes, struct huffCode* codes) {
+    for (int i = 0; i < 256; i++) {
+        codes[i].bits = 0;
+        codes[i].length = 0;
+        if (huffman_codes[i] == NULL) continue;
+
+        int length = strlen(huffman_codes[i]);
+        if (length > 64) {
+            fprintf(stderr, "Error: código de %d bits demasiado largo\n", length);
+            return false;
+        }
+        for (int j = 0; j < length; j++) {
+            codes[i].bits <<= 1;
+            if (huffman_codes[i][j] == '1') {
+                codes[i].bits |= 1;
+            } else if (huffman_codes[i][j] != '0') {
+                fprintf(stderr, "Error: Código inválido encontrado\n");
+                return false;
+            }
+        }
+        codes[i].length = (unsigned char)length;
+    }
+    return true;
+}
+
+// Reserva 'count' entradas al final de la tabla y devuelve su posición
+static int reserveEntries(struct decodeTable* table, int count) {
+    if (table->used + count > table->capacity) {
+        int newCapacity = table->capacity * 2;
+        while (newCapacity < table->used + count) newCapacity *= 2;
+        struct decodeEntry* grown = realloc(table->entries, newCapacity * sizeof(struct decodeEntry));
+        if (grown == NULL) return -1;
+        table->entries = grown;
+        table->capacity = newCapacity;
+    }
+    int offset = table->used;
+    memset(&table->entries[offset], 0, count * sizeof(struct decodeEntry));
+    table->used += count;
+    return offset;
+}
+
+/*
+    Llena una (sub)tabla de 2^tableBits entradas en 'offset'.
+    Los símbolos recibidos comparten sus primeros 'consumed' bits; lo que les
+    queda cabe en esta tabla (hoja, replicada) o pasa a una subtabla.
+*/
+static bool fillDecodeTable(struct decodeTable* table, int offset, int tableBits,
+                            const struct huffCode* codes, const int* symbols, int count, int consumed) {
+    int pending[256];
+    int pendingCount = 0;
+
+    for (int i = 0; i < count; i++) {
+        int symbol = symbols[i];
+        int remaining = codes[symbol].length - consumed;
+        unsigned long long suffix = codes[symbol].bits & ((remaining >= 64) ? ~0ULL : ((1ULL << remaining) - 1));
+
+        if (remaining > tableBits) {
+            pending[pendingCount++] = symbol;
+            continue;
+        }
+
+        int first = (int)(suffix << (tableBits - remaining));
+        int span = 1 << (tableBits - remaining);
+        for (int j = first; j < first + span; j++) {
+            struct decodeEntry* entry = &table->entries[offset + j];
+            if (entry->type != DECODE_INVALID) return false; // No es un código prefijo
+            entry->type = DECODE_LEAF;
+            entry->value = symbol;
+            entry->bits = remaining;
+        }
+    }
+
+    // Agrupar los códigos largos por su índice en esta tabla
+    bool done[256] = { false };
+    for (int i = 0; i < pendingCount; i++) {
+        if (done[i]) continue;
+        int remaining = codes[pending[i]].length - consumed;
+        int index = (int)((codes[pending[i]].bits >> (remaining - tableBits)) & ((1ULL << tableBits) - 1));
+
+        int group[256];
+        int groupCount = 0;
+        int maxRemaining = 0;
+        for (int j = i; j < pendingCount; j++) {
+            int otherRemaining = codes[pending[j]].length - consumed;
+            int otherIndex = (int)((codes[pending[j]].bits >> (otherRemaining - tableBits)) & ((1ULL << tableBits) - 1));
+            if (done[j] || otherIndex != index) continue;
+            done[j] = true;
+            group[groupCount++] = pending[j];
+            if (otherRemaining - tableBits > maxRemaining) maxRemaining = otherRemaining - tableBits;
+        }
+
+        int subBits = (maxRemaining < HUFF_TABLE_BITS) ? maxRemaining : HUFF_TABLE_BITS;
+        if (table->entries[offset + index].type != DECODE_INVALID) return false;
+        int subOffset = reserveEntries(table, 1 << subBits);
+        if (subOffset < 0) return false;
+
+        // reserveEntries puede mover la memoria, por eso se accede con índices
+        table->entries[offset + index].type = DECODE_LINK;
+        table->entries[offset + index].value = subOffset;
+        table->entries[offset + index].bits = subBits;
+
+        if (!fillDecodeTable(table, subOffset, subBits, codes, group, groupCount, consumed + tableBits)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Construye la tabla de decodificación a partir de los códigos.
+ * Cada paso de la decodificación resuelve hasta HUFF_TABLE_BITS bits;
+ * los códigos más largos continúan en subtablas.
+ * @param codes Arreglo de 256 códigos empaquetados (length 0 = sin código).
+ * @return La tabla, o NULL si los códigos no forman un código prefijo.
+ */
+struct decodeTable* buildDecodeTable(const struct huffCode* codes) {
+    struct decodeTable* table = (struct decodeTable*)malloc(sizeof(struct decodeTable));
+    if (table == NULL) return NULL;
+    table->capacity = 2 << HUFF_TABLE_BITS;
+    table->used = 0;
+    table->entries = (struct decodeEntry*)malloc(table->capacity * sizeof(struct decodeEntry));
+    if (table->entries == NULL) { free(table); return NULL; }
+
+    int symbols[256];
+    int count = 0;
+    for (int i = 0; i < 256; i++) {
+        if (codes[i].length > 0) {
+            symbols[count++] = i;
+        }
+    }
+
+    reserveEntries(table, 1 << HUFF_TABLE_BITS);
+    if (!fillDecodeTable(table, 0, HUFF_TABLE_BITS, codes, symbols, count, 0)) {
+        fprintf(stderr, "Error: los códigos no forman un código prefijo válido\n");
+        freeDecodeTable(table);
+        return NULL;
+    }
+    return table;
+}
+
+void freeDecodeTable(struct decodeTable* table) {
+    if (table == NULL) return;
+    free(table->entries);
+    free(table);
+}
+
+
+/*------------------------------------------------------
+
+> Códigos canónicos: solo dependen de las longitudes.
+
+------------------------------------------------------*/
+
+/**
+ * @brief Guarda en 'lengths' la profundidad de cada hoja del árbol.
+ * Un árbol de una sola hoja recibe longitud 1 para que cada símbolo ocupe un bit.
+ * @param lengths Arreglo de 256 longitudes, debe venir en cero.
+ */
+void computeCodeLengths(struct treeNode* root, int depth, unsigned char* lengths) {
+    if (root == NULL) {
+        return;
+    }
+    if (root->left == NULL && root->right == NULL) {
+        int length = (depth == 0) ? 1 : depth;
+        lengths[root->value] = (length > 255) ? 255 : (unsigned char)length;
+        return;
+    }
+    computeCodeLengths(root->left, depth + 1, lengths);
+    computeCodeLengths(root->right, depth + 1, lengths);
+}
+
+// Longitud máxima de los códigos que genera codeLengthsFromFrequencies
+static int codeLengthLimit = HUFF_DEFAULT_CODE_LENGTH_LIMIT;
+
+/**
+ * @brief Cambia la longitud máxima de código para los archivos que se comprimen
+ * después. No afecta la descompresión: las longitudes van en el encabezado.
+ * @return false si el límite está fuera de [HUFF_MIN_CODE_LENGTH_LIMIT, HUFF_MAX_CODE_LENGTH].
+ */
+bool setCodeLengthLimit(int maxLength) {
+    if (maxLength < HUFF_MIN_CODE_LENGTH_LIMIT || maxLength > HUFF_MAX_CODE_LENGTH) {
+        return false;
+    }
+    codeLengthLimit = maxLength;
+    return true;
+}
+
+// Símbolo con su frecuencia, para ordenar las hojas de package-merge
+struct weightedSymbol {
+    unsigned long long weight;
+    int symbol;
+};
+
+static int compareWeightedSymbols(const void* a, const void* b) {
+    const struct weightedSymbol* x = (const struct weightedSymbol*)a;
+    const struct weightedSymbol* y = (const struct weightedSymbol*)b;
+    if (x->weight != y->weight) return (x->weight < y->weight) ? -1 : 1;
+    return x->symbol - y->symbol;
+}
+
+/**
+ * @brief Longitudes de código óptimas con un máximo de maxLength bits (package-merge).
+ * La lista del nivel l mezcla las hojas con los paquetes (pares consecutivos) de
+ * la lista del nivel l - 1. Se eligen los primeros 2n - 2 elementos del último
+ * nivel; la longitud de cada símbolo es la cantidad de elegidos que lo contienen.
+ * Como todas las listas están ordenadas, lo elegido en cada nivel es un prefijo,
+ * así que basta con saber qué posiciones son paquetes para bajar nivel por nivel.
+ * @param frequencies Arreglo de 256 frecuencias.
+ * @param maxLength Longitud máxima (los n símbolos presentes deben caber: 2^maxLength >= n).
+ * @param lengths Arreglo de 256 longitudes de salida (0 = el símbolo no aparece).
+ * @return false si no caben o falta memoria.
+ */
+bool limitedCodeLengths(const unsigned long long* frequencies, int maxLength, unsigned char* lengths) {
+    memset(lengths, 0, 256);
+    struct weightedSymbol leaves[256];
+    int n = 0;
+    for (int i = 0; i < 256; i++) {
+        if (frequencies[i] > 0) {
+            leaves[n].weight = frequencies[i];
+            leaves[n].symbol = i;
+            n++;
+        }
+    }
+    if (n == 0) {
+        return true;
+    }
+    if (n == 1) {
+        lengths[leaves[0].symbol] = 1;
+        return true;
+    }
+    if (maxLength < HUFF_MIN_CODE_LENGTH_LIMIT || maxLength > HUFF_MAX_CODE_LENGTH) {
+        return false;
+    }
+    qsort(leaves, n, sizeof(struct weightedSymbol), compareWeightedSymbols);
+
+    // Cada nivel tiene a lo sumo n hojas + (2n - 1) / 2 paquetes
+    int width = 2 * n;
+    unsigned long long* weights = (unsigned long long*)malloc((size_t)maxLength * width * sizeof(unsigned long long));
+    unsigned char* isPackage = (unsigned char*)malloc((size_t)maxLength * width);
+    int* size = (int*)malloc(maxLength * sizeof(int));
+    if (weights == NULL || isPackage == NULL || size == NULL) {
+        free(weights);
+        free(isPackage);
+        free(size);
+        return false;
+    }
+
+    // Nivel 0: solo hojas
+    for (int i = 0; i < n; i++) {
+        weights[i] = leaves[i].weight;
+        isPackage[i] = 0;
+    }
+    size[0] = n;
+    for (int level = 1; level < maxLength; level++) {
+        const unsigned long long* previous = &weights[(size_t)(level - 1) * width];
+        unsigned long long* current = &weights[(size_t)level * width];
+        unsigned char* flags = &isPackage[(size_t)level * width];
+        int packages = size[level - 1] / 2;
+        int leafIndex = 0, packageIndex = 0, count = 0;
+        while (leafIndex < n || packageIndex < packages) {
+            unsigned long long packageWeight = (packageIndex < packages)
+                ? previous[2 * packageIndex] + previous[2 * packageIndex + 1] : 0;
+            // En empate va primero la hoja
+            if (packageIndex == packages || (leafIndex < n && leaves[leafIndex].weight <= packageWeight)) {
+                current[count] = leaves[leafIndex++].weight;
+                flags[count++] = 0;
+            } else {
+                current[count] = packageWeight;
+                flags[count++] = 1;
+                packageIndex++;
+            }
+        }
+        size[level] = count;
+    }
+
+    // Bajar desde el último nivel: las hojas elegidas son las primeras del orden
+    int selected = 2 * n - 2;
+    for (int level = maxLength - 1; level >= 0 && selected > 0; level--) {
+        const unsigned char* flags = &isPackage[(size_t)level * width];
+        int packages = 0;
+        for (int i = 0; i < selected; i++) {
+            packages += flags[i];
+        }
+        for (int i = 0; i < selected - packages; i++) {
+            lengths[leaves[i].symbol]++;
+        }
+        selected = 2 * packages;
+    }
+
+    free(weights);
+    free(isPackage);
+    free(size);
+    return true;
+}
+
+/**
+ * @brief Calcula las longitudes de código de Huffman para una tabla de frecuencias.
+ * Si algún código pasa el límite (setCodeLengthLimit) se recalculan con package-merge,
+ * que da las mejores longitudes posibles dentro del límite.
+ * @param frequencies Arreglo de 256 frecuencias.
+ * @param lengths Arreglo de 256 longitudes de salida (0 = el símbolo no aparece).
+ * @return false si no se pudo aplicar el límite (falta de memoria).
+ */
+bool codeLengthsFromFrequencies(const unsigned long long* frequencies, unsigned char* lengths) {
+    memset(lengths, 0, 256);
+    struct huffmanTree tree;
+    struct treeNode* root = buildHuffmanTreeArray(&tree, frequencies);
+    computeCodeLengths(root, 0, lengths);
+
+    for (int i = 0; i < 256; i++) {
+        if (lengths[i] > codeLengthLimit) {
+            return limitedCodeLengths(frequencies, codeLengthLimit, lengths);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Divide las frecuencias a la mitad hasta que la suma no pase de limit.
+ * Los símbolos que ya aparecieron quedan en 1 como mínimo (siguen teniendo código),
+ * y lo más reciente pesa más que lo viejo. Con la suma acotada, las longitudes
+ * de código también quedan acotadas.
+ */
+void scaleFrequencies(unsigned long long* frequencies, unsigned long long limit) {
+    while (true) {
+        unsigned long long total = 0;
+        for (int i = 0; i < 256; i++) {
+            total += frequencies[i];
+        }
+        if (total <= limit) {
+            return;
+        }
+        for (int i = 0; i < 256; i++) {
+            if (frequencies[i] > 0) {
+                frequencies[i] = (frequencies[i] + 1) / 2;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Asigna códigos canónicos: los símbolos se ordenan por (longitud, valor)
+ * y reciben códigos consecutivos, así el decodificador solo necesita las longitudes.
+ * @param lengths Arreglo de 256 longitudes (0 = sin código).
+ * @param codes Arreglo de 256 códigos de salida.
+ * @return false si las longitudes no forman un código prefijo válido.
+ */
+bool assignCanonicalCodes(const unsigned char* lengths, struct huffCode* codes) {
+    int countPerLength[HUFF_MAX_CODE_LENGTH + 1] = { 0 };
+    for (int i = 0; i < 256; i++) {
+        if (lengths[i] > HUFF_MAX_CODE_LENGTH) {
+            fprintf(stderr, "Error: longitud de código %d no soportada\n", lengths[i]);
+            return false;
+        }
+        if (lengths[i] > 0) {
+            countPerLength[lengths[i]]++;
+        }
+    }
+
+    unsigned long long nextCode[HUFF_MAX_CODE_LENGTH + 1] = { 0 };
+    unsigned long long code = 0;
+    for (int length = 1; length <= HUFF_MAX_CODE_LENGTH; length++) {
+        code = (code + countPerLength[length - 1]) << 1;
+        nextCode[length] = code;
+        // Verificar que caben todos los códigos de esta longitud
+        if (length < 64 && code + countPerLength[length] > (1ULL << length)) {
+            fprintf(stderr, "Error: longitudes de código inválidas\n");
+            return false;
+        }
+    }
+
+    for (int i = 0; i < 256; i++) {
+        codes[i].length = lengths[i];
+        codes[i].bits = (lengths[i] > 0) ? nextCode[lengths[i]]++ : 0;
+    }
+    return true;
+}
+
+/**
+ * @brief Convierte códigos empaquetados a la tabla de strings "0101" de siempre.
+ * @return char** huffmanCodes[256], liberar con liberarCodigos().
+ */
+char** codesToStrings(const struct huffCode* codes) {
+    char** huffman_codes = (char**)calloc(256, sizeof(char*));
+    if (huffman_codes == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < 256; i++) {
+        if (codes[i].length == 0) continue;
+        huffman_codes[i] = (char*)malloc(codes[i].length + 1);
+        if (huffman_codes[i] == NULL) {
+            liberarCodigos(huffman_codes);
+            return NULL;
+        }
+        for (int j = 0; j < codes[i].length; j++) {
+            huffman_codes[i][j] = ((codes[i].bits >> (codes[i].length - 1 - j)) & 1) ? '1' : '0';
+        }
+        huffman_codes[i][codes[i].length] = '\0';
+    }
+    return huffman_codes;
+}
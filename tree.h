@@ -22,13 +22,251 @@ struct NodeList {
     struct NodeList* next;
 };
 
+// Árbol de Huffman en un arreglo fijo: 256 hojas + 255 nodos internos.
+// Los nodos viven dentro del struct, NO se liberan con freeTree().
+#define HUFF_MAX_NODES 511
+
+struct huffmanTree {
+    struct treeNode nodes[HUFF_MAX_NODES];
+    int count;
+    struct treeNode* root;
+};
+
+// Código de Huffman empaquetado: los bits van alineados a la derecha,
+// el primer bit del código es el más significativo.
+struct huffCode {
+    unsigned long long bits;
+    unsigned char length;
+};
+
+// Encabezado de los archivos comprimidos con códigos canónicos:
+// [char[3] "HFM"][unsigned char modo][long long total][longitudes RLE][datos]
+// Los archivos sin esta marca usan el formato viejo (tabla de frecuencias).
+#define HUFF_MAGIC "HFM"
+#define HUFF_MAGIC_SIZE 3
+#define HUFF_MODE_CANONICAL 1
+#define HUFF_MAX_CODE_LENGTH 64
+// Límite por defecto de las longitudes de código (package-merge si el árbol
+// lo pasa): todo código cabe en una consulta de tabla más una subtabla
+#define HUFF_DEFAULT_CODE_LENGTH_LIMIT 15
+#define HUFF_MIN_CODE_LENGTH_LIMIT 8  // 256 símbolos necesitan al menos 8 bits
+
+// Contenedor por bloques para archivos grandes: cada bloque es un miembro
+// canónico independiente, así se comprime y descomprime en paralelo.
+// [HFM][modo 2][long long total][int tamaño de bloque][int cantidad de bloques]
+// [long long tamaño comprimido de cada bloque (índice)][bloques...]
+#define HUFF_MODE_BLOCKS 2
+#define HUFF_BLOCK_SIZE (1 << 20)
+#define HUFF_BLOCK_THRESHOLD (4 * (size_t)HUFF_BLOCK_SIZE)
+
+// Contenedor por bloques que se escribe de a un bloque, para quien comprime los
+// bloques como tareas de su propio pool (readFile_pthread.c)
+struct blockContainer {
+    FILE* output;
+    long index_offset;        // Dónde va el índice, que se completa al final
+    int block_count;
+    int written;
+    long long* index;
+};
+
+// Miembro canónico con puntos de sincronización, para descomprimir un solo
+// archivo grande en paralelo con una sola tabla de códigos:
+// [HFM][modo 3][long long total][longitudes RLE][int intervalo][long long bytes de datos]
+// [datos][int cantidad de puntos][long long posición en bits de cada punto]
+// El punto k está en el símbolo k * intervalo.
+#define HUFF_MODE_INDEXED 3
+#define HUFF_MAX_SYNC_INTERVAL (1 << 30)
+
+// Modo de flujo (stdin/stdout): no necesita fseek ni conocer el total, y usa
+// memoria constante. [HFM][modo 4] y luego tramas
+// [int tamaño original][int tamaño comprimido][miembro] hasta una trama (0, 0).
+// El miembro es canónico (u otro modo de un solo flujo) o HUFF_MODE_REUSE.
+#define HUFF_MODE_STREAM 4
+
+// Huffman adaptativo (un solo paso, sin tablas en el archivo): los dos lados
+// arrancan con todas las frecuencias en 1 y después de cada trama suman lo
+// visto y recalculan los códigos. Al principio del flujo también recalculan
+// dentro de la trama cada vez que el total llega a 256, 512, 1024... bytes, para
+// no codificar los primeros KB con el modelo plano de 8 bits. [HFM][modo 5] y
+// luego tramas [int tamaño original][int bytes de datos][datos] hasta un int 0.
+#define HUFF_MODE_ADAPTIVE 5
+#define HUFF_ADAPTIVE_INTERVAL (64 * 1024)         // Trama máxima (cada cuánto se recalcula)
+#define HUFF_ADAPTIVE_WARMUP 256                   // Primer recálculo dentro de la trama
+#define HUFF_ADAPTIVE_FREQUENCY_LIMIT (1ULL << 20) // Al pasarlo las frecuencias se dividen a la mitad
+
+// Modelo de contexto de orden 1: la tabla de códigos depende del byte anterior.
+// Los contextos que no pagan su propia tabla comparten la clase 0, así el
+// encabezado no lleva 256 tablas. [HFM][modo 6][long long total][int clases]
+// [clase de cada contexto: 256 bytes con las rachas de ceros como en las longitudes]
+// [longitudes RLE de cada clase][datos]. El primer símbolo usa el contexto 0.
+#define HUFF_MODE_CONTEXT 6
+
+// Transformada previa (BWT + move-to-front + rachas de ceros) antes de Huffman.
+// La BWT se hace por bloques de HUFF_TRANSFORM_BLOCK_SIZE, en paralelo.
+// [HFM][modo 7][long long bytes que siguen][long long total][int bloques]
+// [int índice primario de cada bloque][long long tamaño transformado]
+// [miembro canónico o de contexto con los datos transformados]
+#define HUFF_MODE_TRANSFORM 7
+#define HUFF_TRANSFORM_BLOCK_SIZE (1 << 20)
+#define HUFF_TRANSFORM_MIN_SIZE 1024   // Más chico no paga el encabezado
+#define ZERO_RUN_BOUND(size) ((size) + (size) / 2 + 1)
+
+// LZ77 + Huffman (parecido a deflate): secuencias de literales y coincidencias.
+// Cuatro tablas de 256 símbolos: literales, códigos de cantidad de literales,
+// de largo de coincidencia y de distancia (los códigos llevan bits extra).
+// [HFM][modo 8][long long total][longitudes RLE de las 4 tablas][datos]
+// Cada secuencia: [cantidad de literales][literales] y, si no terminó el
+// miembro, [largo - HUFF_LZ_MIN_MATCH][distancia - 1].
+#define HUFF_MODE_LZ 8
+#define HUFF_LZ_WINDOW (1 << 20)
+#define HUFF_LZ_MIN_MATCH 4
+#define HUFF_LZ_MAX_MATCH (1 << 16)
+#define HUFF_LZ_MAX_LEVEL 9
+#define HUFF_LZ_TABLES 4
+
+// Grupo sólido de archivos chicos dentro de un contenedor: una sola tabla para todos.
+// [HFM][modo 9][int cantidad de miembros][long long total][longitudes RLE][datos]
+// Los miembros van seguidos en los datos; cada entrada del directorio central dice
+// dónde empieza el grupo (group), el primer bit del miembro dentro de los datos
+// (offset) y cuántos bits ocupa (compressedSize). El CRC32 es el de los bytes originales.
+#define HUFF_MODE_SOLID 9
+#define HUFF_SOLID_MEMBER_MAX (64 * 1024)   // Archivos más grandes van como miembro propio
+#define HUFF_SOLID_GROUP_SIZE (1 << 20)     // Bytes originales por grupo
+
+// Miembro codificado con un diccionario entrenado (trainDictionary): no guarda tabla.
+// [HFM][modo 10][long long total][unsigned int id del diccionario][datos]
+// Archivo de diccionario: [char[4] "HFMT"][unsigned int id][longitudes RLE]
+// El id es el CRC32 de las 256 longitudes.
+#define HUFF_MODE_DICTIONARY 10
+#define HUFF_DICTIONARY_MAGIC "HFMT"
+#define HUFF_DICTIONARY_MAGIC_SIZE 4
+#define HUFF_DICTIONARY_DIRECT_MAX (64 * 1024) // Hasta aquí se usa el diccionario sin contar frecuencias
+
+// Trama de HUFF_MODE_STREAM codificada con la tabla de la última trama canónica,
+// cuando sale más barato que guardar una nueva: [HFM][modo 11][long long total][datos]
+#define HUFF_MODE_REUSE 11
+
+// Miembro guardado sin comprimir, cuando la entropía del histograma dice que
+// Huffman no lo achicaría: [HFM][modo 12][long long total][bytes originales]
+#define HUFF_MODE_STORED 12
+#define HUFF_STORED_MIN_SAVING 64          // Hay que ahorrar al menos 1/64 para codificar
+#define HUFF_STORED_SAMPLE_CHUNK (4 * 1024)
+#define HUFF_STORED_SAMPLE_CHUNKS 64       // Muestra de los archivos grandes: 64 tramos de 4 KB
+
+struct lzSequence {
+    unsigned int literals;
+    unsigned int matchLength;  // 0 solo en la última secuencia
+    unsigned int distance;
+};
+
+// Desde este tamaño el conteo de frecuencias se reparte entre varios hilos
+#define HUFF_PARALLEL_HISTOGRAM_MIN ((size_t)8 << 20)
+
+// Vista de solo lectura de un archivo de entrada: mmap si es un archivo
+// regular, o un buffer leído por bloques si es stdin ("-") o un pipe.
+struct inputView {
+    const unsigned char* data;
+    size_t size;
+    bool mapped;
+};
+
+// Un archivo regular encontrado por walkDirectory (readFile_walk.c)
+struct walkEntry {
+    char* path;       // inputDir/relativo, para abrirlo
+    char* name;       // Ruta relativa a inputDir (con '/'): el nombre del miembro
+    long long size;
+};
+
+// Contenedor de directorios:
+// [char[4] "HFMA"][unsigned char versión][miembros comprimidos uno tras otro]
+// [directorio central][long long posición del directorio][int cantidad][char[4] "HFMD"]
+#define ARCHIVE_MAGIC "HFMA"
+#define ARCHIVE_TRAILER_MAGIC "HFMD"
+#define ARCHIVE_MAGIC_SIZE 4
+#define ARCHIVE_VERSION 2          // 2: cada entrada lleva [long long grupo]
+#define ARCHIVE_MAX_NAME 1000
+// Los miembros de hasta este tamaño comprimido se leen con un solo pread
+// (que sirve también para el CRC32) y se decodifican desde memoria
+#define ARCHIVE_INLINE_MEMBER_MAX ((long long)HUFF_BLOCK_THRESHOLD)
+
+struct archiveEntry {
+    char* name;
+    long long offset;         // Posición del miembro comprimido dentro del contenedor (en un grupo, primer bit)
+    long long originalSize;   // -1 en el formato viejo (no se guardaba)
+    long long compressedSize; // En bytes; en un grupo, cantidad de bits
+    // CRC32 de los bytes del miembro comprimido (en uno guardado, encabezado +
+    // bytes originales); en un miembro agrupado, de sus bytes originales
+    unsigned int checksum;
+    long long group;          // -1 = miembro propio; si no, posición de su grupo (ver HUFF_MODE_SOLID)
+};
+
+struct archiveDirectory {
+    int version;              // 0 = formato viejo, sin directorio central
+    int count;
+    int capacity;
+    struct archiveEntry* entries;
+};
+
+// Tabla de decodificación: se indexa con los siguientes HUFF_TABLE_BITS bits
+// del flujo. Los códigos más largos saltan a subtablas (segundo nivel o más).
+#define HUFF_TABLE_BITS 10
+
+#define DECODE_INVALID 0
+#define DECODE_LEAF 1
+#define DECODE_LINK 2
+
+struct decodeEntry {
+    unsigned int value;  // Hoja: el símbolo. Enlace: posición de la subtabla
+    unsigned char bits;  // Hoja: bits del código. Enlace: bits de índice de la subtabla
+    unsigned char type;  // DECODE_INVALID, DECODE_LEAF o DECODE_LINK
+};
+
+struct decodeTable {
+    struct decodeEntry* entries;
+    int used;
+    int capacity;
+};
+
+// Tablas del modo de contexto, una por clase
+struct contextModel {
+    int classCount;
+    unsigned char classOf[256];      // Clase de cada byte anterior
+    struct decodeTable* tables[256]; // Tabla de cada clase
+};
+
+// Contexto de decodificación: el encabezado se lee una sola vez, de un FILE*
+// ya abierto o de un miembro completo en memoria, y se decodifica ahí mismo.
+struct huffDecoder {
+    int mode;                  // HUFF_MODE_* o 0 para el formato viejo
+    long long total;           // Caracteres originales (modos 0 y 1)
+    struct decodeTable* table; // NULL si el original está vacío o tiene un solo símbolo
+    struct contextModel* context; // Solo en HUFF_MODE_CONTEXT (en vez de table)
+    struct decodeTable* lzTables[HUFF_LZ_TABLES - 1]; // HUFF_MODE_LZ: literales, largos y distancias (table = bytes)
+    unsigned char previous;    // Último byte decodificado, para elegir la tabla de contexto
+    int singleSymbol;          // Formato viejo con un solo símbolo distinto, -1 si no
+    FILE* file;                // Fuente de archivo, o NULL si es de memoria
+    const unsigned char* data; // Fuente en memoria: los bytes después del encabezado
+    size_t size;
+};
+
 
 // Para tree
 struct treeNode* createNode(unsigned char value, unsigned long long int frequency);
 void printTree(struct treeNode* root, int level);
 struct treeNode* buildHuffmanTree(struct letter* letters, int size);
+struct treeNode* buildHuffmanTreeArray(struct huffmanTree* tree, const unsigned long long* frequencies);
 void generateCodes(struct treeNode* root, char* path, int depth, char** huffman_codes);
 void freeTree(struct treeNode* root);
+bool codesFromStrings(char** huffman_codes, struct huffCode* codes);
+void computeCodeLengths(struct treeNode* root, int depth, unsigned char* lengths);
+bool codeLengthsFromFrequencies(const unsigned long long* frequencies, unsigned char* lengths);
+bool assignCanonicalCodes(const unsigned char* lengths, struct huffCode* codes);
+void scaleFrequencies(unsigned long long* frequencies, unsigned long long limit);
+bool limitedCodeLengths(const unsigned long long* frequencies, int maxLength, unsigned char* lengths);
+bool setCodeLengthLimit(int maxLength);
+char** codesToStrings(const struct huffCode* codes);
+struct decodeTable* buildDecodeTable(const struct huffCode* codes);
+void freeDecodeTable(struct decodeTable* table);
 
 
 // Para lo de archivos
@@ -38,8 +276,23 @@ char** reconstruirCodigos(const char* compressedFileName);
 bool obtenerTablaDeFrecuencias(const char* fileName, unsigned long long* frequencies);
 long long obtenerCantidadDeCaracteres(const char* fileName);
 void compressFile(const char *inputFileName, const char* outputFileName);
+void countFrequencies(const unsigned char* data, size_t size, unsigned long long* frequencies);
+bool openInputView(const char* fileName, struct inputView* view);
+bool countFileFrequencies(const char* fileName, unsigned long long* frequencies, long long* bytes);
+void closeInputView(struct inputView* view);
+void prefetchInputView(const struct inputView* view);
 struct letter* terribleSort();
 bool decompressFile(const char* compressedFileName, const char* outputFileName);
+bool decompressStream(FILE* compressedFile, FILE* outputFile);
+bool openDecoderFile(struct huffDecoder* decoder, FILE* input);
+bool openDecoderMemory(struct huffDecoder* decoder, const unsigned char* data, size_t size);
+long long runDecoder(struct huffDecoder* decoder, FILE* outputFile);
+void closeDecoder(struct huffDecoder* decoder);
+bool compressStreaming(FILE* inputFile, FILE* outputFile);
+bool compressStreamingCounted(FILE* inputFile, FILE* outputFile, long long* total);
+bool compressAdaptive(FILE* inputFile, FILE* outputFile);
+bool compressFileToStream(const char* inputFileName, FILE* outputFile, long long* originalSize);
+bool compressFileToMemory(const char* inputFileName, unsigned char** data, size_t* size, long long* originalSize);
 struct treeNode* createDecodingTree(char** huffman_codes);
 bool compressDirectory(const char* inputDir, const char* outputFile);
 void listFilesToCompress(const char* inputDir);
@@ -47,16 +300,83 @@ bool isRegularFile(const char* filepath);
 bool decompressDirectory(const char* compressedFile, const char* outputDir);
 bool createDirectoryIfNotExists(const char* dirPath);
 void listCompressedDirectoryContents(const char* compressedFile);
+unsigned int crc32Update(unsigned int crc, const unsigned char* data, size_t size);
+void writeArchiveHeader(FILE* output);
+bool appendArchiveMember(FILE* output, struct archiveDirectory* directory, const char* name,
+                         const unsigned char* data, size_t size, long long originalSize);
+bool fileMemberUsesBlocks(const struct inputView* view);
+bool finishArchiveMember(FILE* output, struct archiveDirectory* directory, const char* name,
+                         long long offset, long long originalSize, bool written);
+bool compressArchiveMember(FILE* output, struct archiveDirectory* directory, const char* name,
+                           const char* inputPath);
+bool compressArchiveGroup(FILE* output, struct archiveDirectory* directory,
+                          const struct walkEntry* files, int count);
+void setSolidGroups(bool enabled);
+bool trainDictionary(const char* sampleDir, const char* dictionaryFile);
+bool loadDictionary(const char* dictionaryFile);
+bool writeArchiveDirectory(FILE* output, const struct archiveDirectory* directory);
+bool readArchiveDirectory(FILE* input, struct archiveDirectory* directory);
+void freeArchiveDirectory(struct archiveDirectory* directory);
+const struct archiveEntry* findArchiveEntry(const struct archiveDirectory* directory, const char* name);
+bool extractArchiveMember(FILE* input, const struct archiveEntry* entry, const char* outputPath);
+bool extractFilesFromArchive(const char* compressedFile, const char* outputDir, char** names, int nameCount);
 
 //para fork
 long long getCurrentTimeMs();
 void printProcessInfo(const char* message);
 int countFilesInDirectory(const char* inputDir);
+void setForkProcessLimit(int limit);
 
 bool compressDirectoryFork(const char* inputDir, const char* outputFile);
 bool decompressDirectoryFork(const char* compressedFile, const char* outputDir);
 
 
+// Para bloques (readFile_blocks.c)
+bool encodeMember(const unsigned char* data, size_t size, FILE* outputFile);
+bool encodeMemberToMemory(const unsigned char* data, size_t size, unsigned char** out, size_t* outSize);
+bool decodeMemberFromMemory(const unsigned char* data, size_t size, unsigned char* out, size_t expectedSize);
+bool decodeSymbolsFromMemory(const struct decodeTable* table, const unsigned char* data, size_t size,
+                             int skipBits, unsigned char* out, size_t count);
+void setSyncPointInterval(size_t interval);
+void setContextModeling(bool enabled);
+void setBlockTransform(bool enabled);
+bool setLzLevel(int level);
+int getWorkerCount();
+void countFrequenciesParallel(const unsigned char* data, size_t size, unsigned long long* frequencies);
+bool compressBlocks(const unsigned char* data, size_t size, FILE* outputFile);
+int blockCountFor(size_t size);
+bool beginBlockContainer(struct blockContainer* container, FILE* outputFile, size_t size);
+void writeContainerBlock(struct blockContainer* container, const unsigned char* block, size_t bytes);
+bool finishBlockContainer(struct blockContainer* container, bool ok);
+long long decompressBlocks(FILE* compressedFile, FILE* outputFile);
+bool decompressSyncPoints(int inputFd, long long dataOffset, long long dataBytes, const struct decodeTable* table,
+                          long long total, int interval, const long long* bitOffsets, int pointCount, FILE* outputFile);
+
+
+// Para la transformada previa (readFile_transform.c)
+int bwtForward(const unsigned char* data, int n, unsigned char* out);
+bool bwtInverse(const unsigned char* in, int n, int primary, unsigned char* out);
+void mtfEncode(unsigned char* data, size_t size);
+void mtfDecode(unsigned char* data, size_t size);
+size_t zeroRunEncode(const unsigned char* in, size_t size, unsigned char* out);
+bool zeroRunDecode(const unsigned char* in, size_t size, unsigned char* out, size_t expectedSize);
+int transformBlockCount(size_t size);
+bool bwtForwardBlocks(const unsigned char* data, size_t size, unsigned char* out, int* primary);
+bool bwtInverseBlocks(const unsigned char* in, size_t size, int* primary, unsigned char* out);
+
+
+// Para LZ77 (readFile_lz.c)
+bool lzFindSequences(const unsigned char* data, size_t size, int level,
+                     struct lzSequence** sequences, size_t* count);
+unsigned char lzValueCode(unsigned int value, int* extraBits);
+bool lzValueBase(unsigned char code, unsigned int* base, int* extraBits);
+
+
+// Para el recorrido recursivo (readFile_walk.c)
+struct walkEntry* walkDirectory(const char* inputDir, int* count);
+void freeWalkEntries(struct walkEntry* entries, int count);
+
+
 // para pthread
 bool compressDirectoryPthread(const char* inputDir, const char* outputFile);
 bool decompressDirectoryPthread(const char* compressedFile, const char* outputDir);